@@ -22,13 +22,15 @@ class JScriptConan(ConanFile):
         "dll_sign": [False, True],
         "ninja": [False, True],
         "cmake": [False, True],
-        "with_unit_tests": [False, True]
+        "with_unit_tests": [False, True],
+        "node_snapshot": [False, True]
     }
     default_options = {
         "dll_sign": True,
         "ninja": False,
         "cmake": False,
-        "with_unit_tests": False
+        "with_unit_tests": False,
+        "node_snapshot": False
     }
     exports_patches = [
         "oda.patch",
@@ -55,6 +57,8 @@ class JScriptConan(ConanFile):
     def configure(self):
         if self.settings.os != "Windows":
             del self.options.dll_sign
+        if self.settings.os == "Windows":
+            del self.options.node_snapshot
 
     def requirements(self):
         self.requires("openssl/%s@%s/%s" % (self._openssl_version, self.user, self._openssl_channel))
@@ -132,6 +136,9 @@ class JScriptConan(ConanFile):
             flags.append("--ninja")
         elif self.options.cmake:
             flags.append("--cmake")
+        # Startup snapshot builder
+        if self.options.get_safe("node_snapshot"):
+            flags.append("--jscript-node-snapshot")
         #
         env = {}
         if self.settings.os == "Linux":
@@ -181,6 +188,10 @@ class JScriptConan(ConanFile):
                 msbuild.build("node.sln", targets=["Build"], upgrade_project=False, verbosity="normal", use_env=False, platforms={"x86" : "Win32"})
             else:
                 self.run("make -j %s" % tools.cpu_count())
+            # Startup snapshot blob, loaded by LoadStartupSnapshot()
+            if self.options.get_safe("node_snapshot"):
+                output_folder = "out/%s" % str(self.settings.build_type)
+                self.run("%s/node_mksnapshot --blob %s/jscript_snapshot.blob" % (output_folder, output_folder))
             # Tests
             if self.options.with_unit_tests:
                 shell = str(self.settings.build_type) + "/" + output_name
@@ -251,6 +262,7 @@ class JScriptConan(ConanFile):
                     symlink = fname[0:fname.rfind(extension) + len(extension)]
                     self.run("ln --symbolic --force \"%s\" \"%s\"" % (fname, symlink))
             self.copy("jscript", dst="bin", src=output_folder, keep_path=False)
+            self.copy("jscript_snapshot.blob", dst="bin", src=output_folder, keep_path=False)
         # Local build
         if not self.in_local_cache:
             self.copy("conanfile.py", dst=".", keep_path=False)
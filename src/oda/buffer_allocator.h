@@ -0,0 +1,235 @@
+/*
+ * ODANT jscript, PoolingArrayBufferAllocator
+*/
+
+
+#pragma once
+
+
+#include "jscript.h"
+#include "node_internals.h"
+#include "node_mutex.h"
+#include "util-inl.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+
+namespace node {
+namespace jscript {
+
+
+// ArrayBuffer allocator of instance with accounting, optional limit of live memory
+// and pooling of freed backing stores. With pooling sizes from 1 KiB to 4 MiB are
+// rounded up to power of two size classes, freed blocks are kept in per-class free
+// lists up to pool size. Allocation over limit fails, V8 throws RangeError then.
+// Free() can be called from any thread, also after isolate is disposed.
+
+class PoolingArrayBufferAllocator final : public NodeArrayBufferAllocator {
+public:
+  PoolingArrayBufferAllocator(std::size_t limit, std::size_t poolSize);
+  ~PoolingArrayBufferAllocator() override;
+
+  PoolingArrayBufferAllocator(const PoolingArrayBufferAllocator&) = delete;
+  PoolingArrayBufferAllocator& operator=(const PoolingArrayBufferAllocator&) = delete;
+
+  void* Allocate(size_t size) override;
+  void* AllocateUninitialized(size_t size) override;
+  void Free(void* data, size_t size) override;
+  void* Reallocate(void* data, size_t oldSize, size_t size) override;
+
+  // Fills arrayBuffer* counters except allocation rate
+  void get(InstanceStats* stats) const;
+  // Requested bytes since creation
+  uint64_t allocatedBytes() const;
+
+private:
+  static constexpr std::size_t minClassShift = 10;
+  static constexpr std::size_t maxClassShift = 22;
+  static constexpr std::size_t classCount = maxClassShift - minClassShift + 1;
+
+  // Size class of pooled allocation or classCount
+  std::size_t sizeClass(std::size_t size) const;
+  std::size_t blockSize(std::size_t size) const;
+
+  void* allocate(std::size_t size, bool zeroFill);
+  bool reserve(std::size_t block);
+  void release(std::size_t block);
+
+  const std::size_t _limit;
+  const std::size_t _poolSize;
+
+  std::atomic<std::size_t> _live{0};
+  std::atomic<std::size_t> _peak{0};
+  std::atomic<std::size_t> _pooled{0};
+  std::atomic<uint64_t> _allocated{0};
+  std::atomic<std::size_t> _allocations{0};
+  std::atomic<std::size_t> _poolHits{0};
+  std::atomic<std::size_t> _failures{0};
+
+  node::Mutex _mutex;
+  std::vector<void*> _pools[classCount];
+};
+
+
+inline PoolingArrayBufferAllocator::PoolingArrayBufferAllocator(std::size_t limit, std::size_t poolSize)
+  :
+    _limit{limit},
+    _poolSize{poolSize}
+{}
+
+inline PoolingArrayBufferAllocator::~PoolingArrayBufferAllocator() {
+  for (auto& pool : _pools) {
+    for (void* data : pool) {
+      std::free(data);
+    }
+  }
+}
+
+inline void* PoolingArrayBufferAllocator::Allocate(size_t size) {
+  return allocate(size, *zero_fill_field() != 0 || per_process::cli_options->zero_fill_all_buffers);
+}
+
+inline void* PoolingArrayBufferAllocator::AllocateUninitialized(size_t size) {
+  return allocate(size, false);
+}
+
+inline void PoolingArrayBufferAllocator::Free(void* data, size_t size) {
+  if (data == nullptr) {
+    return;
+  }
+
+  NodeArrayBufferAllocator::UnregisterPointer(data, size);
+  const std::size_t block = blockSize(size);
+  release(block);
+
+  const std::size_t index = sizeClass(size);
+  if (index != classCount) {
+    node::Mutex::ScopedLock lock{_mutex};
+    if (_pooled + block <= _poolSize) {
+      _pools[index].push_back(data);
+      _pooled += block;
+      return;
+    }
+  }
+
+  std::free(data);
+}
+
+inline void* PoolingArrayBufferAllocator::Reallocate(void* data, size_t oldSize, size_t size) {
+  if (size == 0) {
+    Free(data, oldSize);
+    return nullptr;
+  }
+
+  // Block of pooled size class has room up to class size
+  if (data != nullptr && sizeClass(oldSize) != classCount && blockSize(oldSize) == blockSize(size)) {
+    NodeArrayBufferAllocator::UnregisterPointer(data, oldSize);
+    NodeArrayBufferAllocator::RegisterPointer(data, size);
+    return data;
+  }
+
+  void* result = allocate(size, false);
+  if (result == nullptr) {
+    return nullptr;
+  }
+  if (data != nullptr) {
+    std::memcpy(result, data, std::min(oldSize, size));
+    Free(data, oldSize);
+  }
+  return result;
+}
+
+inline void PoolingArrayBufferAllocator::get(InstanceStats* stats) const {
+  stats->arrayBufferLive = _live;
+  stats->arrayBufferPeak = _peak;
+  stats->arrayBufferPooled = _pooled;
+  stats->arrayBufferAllocations = _allocations;
+  stats->arrayBufferPoolHits = _poolHits;
+  stats->arrayBufferFailures = _failures;
+}
+
+inline uint64_t PoolingArrayBufferAllocator::allocatedBytes() const {
+  return _allocated;
+}
+
+inline std::size_t PoolingArrayBufferAllocator::sizeClass(std::size_t size) const {
+  if (_poolSize == 0 || size > (std::size_t{1} << maxClassShift)) {
+    return classCount;
+  }
+
+  std::size_t shift = minClassShift;
+  while ((std::size_t{1} << shift) < size) {
+    ++shift;
+  }
+  return shift - minClassShift;
+}
+
+inline std::size_t PoolingArrayBufferAllocator::blockSize(std::size_t size) const {
+  const std::size_t index = sizeClass(size);
+  return index != classCount ? std::size_t{1} << (index + minClassShift) : size;
+}
+
+inline void* PoolingArrayBufferAllocator::allocate(std::size_t size, bool zeroFill) {
+  const std::size_t block = blockSize(size);
+  if (!reserve(block)) {
+    ++_failures;
+    return nullptr;
+  }
+
+  void* data = nullptr;
+  const std::size_t index = sizeClass(size);
+  if (index != classCount) {
+    node::Mutex::ScopedLock lock{_mutex};
+    if (!_pools[index].empty()) {
+      data = _pools[index].back();
+      _pools[index].pop_back();
+      _pooled -= block;
+    }
+  }
+
+  if (data != nullptr) {
+    ++_poolHits;
+    if (zeroFill) {
+      std::memset(data, 0, size);
+    }
+  }
+  else {
+    data = zeroFill ? UncheckedCalloc(block) : UncheckedMalloc(block);
+    if (data == nullptr) {
+      release(block);
+      return nullptr;
+    }
+  }
+
+  ++_allocations;
+  _allocated += size;
+  NodeArrayBufferAllocator::RegisterPointer(data, size);
+  return data;
+}
+
+inline bool PoolingArrayBufferAllocator::reserve(std::size_t block) {
+  std::size_t live = _live.load(std::memory_order_relaxed);
+  do {
+    if (_limit != 0 && live + block > _limit) {
+      return false;
+    }
+  } while (!_live.compare_exchange_weak(live, live + block, std::memory_order_relaxed));
+
+  const std::size_t newLive = live + block;
+  std::size_t peak = _peak.load(std::memory_order_relaxed);
+  while (newLive > peak && !_peak.compare_exchange_weak(peak, newLive, std::memory_order_relaxed)) {}
+  return true;
+}
+
+inline void PoolingArrayBufferAllocator::release(std::size_t block) {
+  _live.fetch_sub(block, std::memory_order_relaxed);
+}
+
+
+} // namespace jscript
+} // namespace node
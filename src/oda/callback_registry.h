@@ -0,0 +1,133 @@
+/*
+ * ODANT jscript, CallbackRegistry
+*/
+
+
+#pragma once
+
+
+#include "jscript.h"
+#include "node_mutex.h"
+
+#include <v8.h>
+
+#include <algorithm>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+
+namespace node {
+namespace jscript {
+
+
+// Host functions bound to global object of instance context.
+// Function is created from FunctionTemplate once and not re-bound while
+// global property still holds it, so inline caches on global stay valid.
+// Must be used (and cleared) only from instance thread while isolate is alive.
+
+class CallbackRegistry {
+public:
+  CallbackRegistry() = default;
+
+  CallbackRegistry(const CallbackRegistry&) = delete;
+  CallbackRegistry& operator=(const CallbackRegistry&) = delete;
+
+  void bind(v8::Local<v8::Context> context, const JSCallbackInfo& callbackInfo);
+  void clear();
+
+  // Process-wide callbacks, bound to context of every new instance
+  static void registerGlobal(const std::vector<JSCallbackInfo>& callbacks);
+  static std::vector<JSCallbackInfo> globalCallbacks();
+
+private:
+  struct Entry {
+    v8::FunctionCallback function;
+    void* external;
+    const v8::CFunction* fastFunction;
+    v8::Global<v8::Function> bound;
+  };
+
+  static node::Mutex& globalMutex();
+  static std::vector<JSCallbackInfo>& globalList();
+
+  std::unordered_map<std::string, Entry> _entries;
+};
+
+
+inline void CallbackRegistry::bind(v8::Local<v8::Context> context, const JSCallbackInfo& callbackInfo) {
+  v8::Isolate* isolate = context->GetIsolate();
+
+  v8::Local<v8::String> name = v8::String::NewFromUtf8(isolate, callbackInfo.name.c_str(),
+                                                       v8::NewStringType::kInternalized, callbackInfo.name.length()).ToLocalChecked();
+  v8::Local<v8::Object> global = context->Global();
+
+  auto it = _entries.find(callbackInfo.name);
+  if (it != std::end(_entries)) {
+    const Entry& entry = it->second;
+    if (entry.function == callbackInfo.function && entry.external == callbackInfo.external &&
+        entry.fastFunction == callbackInfo.fastFunction) {
+      v8::Local<v8::Value> current;
+      if (global->Get(context, name).ToLocal(&current) && current->StrictEquals(entry.bound.Get(isolate))) {
+        return;
+      }
+    }
+  }
+
+  v8::Local<v8::Value> external;
+  if (callbackInfo.external) {
+    external = v8::External::New(isolate, callbackInfo.external);
+  }
+
+  v8::Local<v8::FunctionTemplate> functionTemplate =
+      v8::FunctionTemplate::New(isolate, callbackInfo.function, external, v8::Local<v8::Signature>(), 0,
+                                v8::ConstructorBehavior::kThrow, v8::SideEffectType::kHasSideEffect,
+                                callbackInfo.fastFunction);
+  functionTemplate->SetClassName(name);
+
+  v8::Local<v8::Function> function = functionTemplate->GetFunction(context).ToLocalChecked();
+  function->SetName(name);
+  global->Set(context, name, function).Check();
+
+  _entries[callbackInfo.name] = Entry{callbackInfo.function, callbackInfo.external, callbackInfo.fastFunction,
+                                      v8::Global<v8::Function>{isolate, function}};
+}
+
+inline void CallbackRegistry::clear() {
+  _entries.clear();
+}
+
+inline void CallbackRegistry::registerGlobal(const std::vector<JSCallbackInfo>& callbacks) {
+  node::Mutex::ScopedLock lock{globalMutex()};
+  std::vector<JSCallbackInfo>& list = globalList();
+  for (const JSCallbackInfo& callbackInfo : callbacks) {
+    auto it = std::find_if(std::begin(list), std::end(list), [&callbackInfo](const JSCallbackInfo& registered) {
+      return registered.name == callbackInfo.name;
+    });
+    if (it != std::end(list)) {
+      *it = callbackInfo;
+    }
+    else {
+      list.push_back(callbackInfo);
+    }
+  }
+}
+
+inline std::vector<JSCallbackInfo> CallbackRegistry::globalCallbacks() {
+  node::Mutex::ScopedLock lock{globalMutex()};
+  return globalList();
+}
+
+inline node::Mutex& CallbackRegistry::globalMutex() {
+  static node::Mutex mutex;
+  return mutex;
+}
+
+inline std::vector<JSCallbackInfo>& CallbackRegistry::globalList() {
+  static std::vector<JSCallbackInfo> list;
+  return list;
+}
+
+
+} // namespace jscript
+} // namespace node
@@ -0,0 +1,230 @@
+/*
+ * ODANT jscript, ConsoleSink and ConsoleDispatcher
+*/
+
+
+#pragma once
+
+
+#include "jscript.h"
+#include "node_mutex.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+
+namespace node {
+namespace jscript {
+
+
+// Console messages of one instance. Without batching the callback is called
+// directly from instance thread. With batching messages are written to
+// a bounded single-producer ring buffer and delivered by ConsoleDispatcher,
+// overflowing messages are dropped and reported by next batch.
+
+class ConsoleSink {
+public:
+  ConsoleSink(uint64_t instanceId, ConsoleMessageCallback callback, const ConsoleOptions& options);
+
+  ConsoleSink(const ConsoleSink&) = delete;
+  ConsoleSink& operator=(const ConsoleSink&) = delete;
+
+  bool isBatched() const;
+
+  // Instance thread, returns true if dispatcher should be woken up
+  bool write(ConsoleType type, std::string text);
+
+  // Consumers are serialized
+  void flush();
+
+private:
+  const uint64_t _instanceId;
+  ConsoleMessageCallback _callback;
+  const bool _isBatched;
+
+  std::vector<ConsoleMessage> _ring;
+  std::atomic<std::size_t> _head{0};  // next write, owned by producer
+  std::atomic<std::size_t> _tail{0};  // next read, owned by consumer
+  std::atomic<std::size_t> _dropped{0};
+
+  node::Mutex _flush_mutex;
+  std::vector<ConsoleMessage> _batch;
+};
+
+
+inline ConsoleSink::ConsoleSink(uint64_t instanceId, ConsoleMessageCallback callback, const ConsoleOptions& options)
+  :
+    _instanceId{instanceId},
+    _callback{std::move(callback)},
+    _isBatched{options.batched},
+    _ring(options.batched ? std::max<std::size_t>(options.bufferSize, 2) : 0)
+{}
+
+inline bool ConsoleSink::isBatched() const {
+  return _isBatched;
+}
+
+inline bool ConsoleSink::write(ConsoleType type, std::string text) {
+  if (!_isBatched) {
+    ConsoleMessage message{type, std::move(text), _instanceId};
+    _callback(&message, 1);
+    return false;
+  }
+
+  const std::size_t head = _head.load(std::memory_order_relaxed);
+  const std::size_t tail = _tail.load(std::memory_order_acquire);
+  const std::size_t used = head - tail;
+  if (used == _ring.size()) {
+    ++_dropped;
+    return true;
+  }
+
+  ConsoleMessage& message = _ring[head % _ring.size()];
+  message.type = type;
+  message.text = std::move(text);
+  message.instanceId = _instanceId;
+  _head.store(head + 1, std::memory_order_release);
+
+  // Wake up dispatcher once per half of buffer, otherwise it flushes by interval
+  return used + 1 == _ring.size() / 2;
+}
+
+inline void ConsoleSink::flush() {
+  if (!_isBatched) {
+    return;
+  }
+
+  node::Mutex::ScopedLock lock{_flush_mutex};
+
+  const std::size_t tail = _tail.load(std::memory_order_relaxed);
+  const std::size_t head = _head.load(std::memory_order_acquire);
+  for (std::size_t i = tail; i != head; ++i) {
+    _batch.push_back(std::move(_ring[i % _ring.size()]));
+  }
+  _tail.store(head, std::memory_order_release);
+
+  const std::size_t dropped = _dropped.exchange(0);
+  if (dropped != 0) {
+    _batch.push_back(ConsoleMessage{ConsoleType::Warn,
+                                    "jscript: " + std::to_string(dropped) + " console messages dropped, buffer is full",
+                                    _instanceId});
+  }
+
+  if (!_batch.empty()) {
+    _callback(_batch.data(), _batch.size());
+    _batch.clear();
+  }
+}
+
+
+// Process-wide thread, delivers batched console messages of all instances.
+
+class ConsoleDispatcher {
+public:
+  ConsoleDispatcher() = default;
+
+  ConsoleDispatcher(const ConsoleDispatcher&) = delete;
+  ConsoleDispatcher& operator=(const ConsoleDispatcher&) = delete;
+
+  static ConsoleDispatcher& global();
+
+  void add(std::shared_ptr<ConsoleSink> sink);
+  // Delivers remaining messages of sink before return
+  void remove(const std::shared_ptr<ConsoleSink>& sink);
+  void wakeup();
+  void shutdown();
+
+private:
+  void run();
+
+  static constexpr std::chrono::milliseconds flushInterval{20};
+
+  std::mutex _mutex;
+  std::condition_variable _cv;
+  std::vector<std::shared_ptr<ConsoleSink>> _sinks;
+  std::thread _thread;
+  bool _wakeup{false};
+  bool _stop{false};
+};
+
+
+constexpr std::chrono::milliseconds ConsoleDispatcher::flushInterval;
+
+inline ConsoleDispatcher& ConsoleDispatcher::global() {
+  static ConsoleDispatcher consoleDispatcher{};
+  return consoleDispatcher;
+}
+
+inline void ConsoleDispatcher::add(std::shared_ptr<ConsoleSink> sink) {
+  std::unique_lock<std::mutex> lock{_mutex};
+  if (_stop) {
+    return;
+  }
+  _sinks.push_back(std::move(sink));
+  if (!_thread.joinable()) {
+    _thread = std::thread([this]() { run(); });
+  }
+}
+
+inline void ConsoleDispatcher::remove(const std::shared_ptr<ConsoleSink>& sink) {
+  {
+    std::unique_lock<std::mutex> lock{_mutex};
+    _sinks.erase(std::remove(std::begin(_sinks), std::end(_sinks), sink), std::end(_sinks));
+  }
+  sink->flush();
+}
+
+inline void ConsoleDispatcher::wakeup() {
+  {
+    std::unique_lock<std::mutex> lock{_mutex};
+    _wakeup = true;
+  }
+  _cv.notify_one();
+}
+
+inline void ConsoleDispatcher::shutdown() {
+  std::vector<std::shared_ptr<ConsoleSink>> sinks;
+  {
+    std::unique_lock<std::mutex> lock{_mutex};
+    _stop = true;
+    sinks.swap(_sinks);
+  }
+  _cv.notify_one();
+
+  if (_thread.joinable()) {
+    _thread.join();
+  }
+
+  for (const auto& sink : sinks) {
+    sink->flush();
+  }
+}
+
+inline void ConsoleDispatcher::run() {
+  std::vector<std::shared_ptr<ConsoleSink>> sinks;
+  std::unique_lock<std::mutex> lock{_mutex};
+  while (!_stop) {
+    _cv.wait_for(lock, flushInterval, [this]() { return _stop || _wakeup; });
+    _wakeup = false;
+
+    sinks = _sinks;
+    lock.unlock();
+    for (const auto& sink : sinks) {
+      sink->flush();
+    }
+    sinks.clear();
+    lock.lock();
+  }
+}
+
+
+} // namespace jscript
+} // namespace node
@@ -0,0 +1,249 @@
+/*
+ * ODANT jscript, InstanceMetrics
+*/
+
+
+#pragma once
+
+
+#include "jscript.h"
+#include "buffer_allocator.h"
+#include "histogram-inl.h"
+#include "node_mutex.h"
+
+#include <uv.h>
+#include <v8.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+
+
+namespace node {
+namespace jscript {
+
+
+// Counters are updated from instance thread, read by get() from any thread.
+// Event loop is read only between start() and stop(), under mutex.
+// Allocator is kept after stop(), its backing stores can outlive isolate.
+
+class InstanceMetrics {
+public:
+  InstanceMetrics() = default;
+
+  InstanceMetrics(const InstanceMetrics&) = delete;
+  InstanceMetrics& operator=(const InstanceMetrics&) = delete;
+
+  void start(uv_loop_t* loop, v8::Isolate* isolate, std::shared_ptr<PoolingArrayBufferAllocator> allocator);
+  void stop(v8::Isolate* isolate);
+
+  void scriptQueued(ScriptPriority priority);
+  void scriptDequeued(ScriptPriority priority, uint64_t queuedTime, uint64_t dequeueTime);
+  void scriptDone(uint64_t queuedTime, uint64_t endTime);
+  void sampleHeap(v8::Isolate* isolate);
+
+  void get(InstanceStats* stats);
+
+private:
+  static void gcPrologue(v8::Isolate* isolate, v8::GCType type, v8::GCCallbackFlags flags, void* data);
+  static void gcEpilogue(v8::Isolate* isolate, v8::GCType type, v8::GCCallbackFlags flags, void* data);
+
+  static std::chrono::microseconds toMicroseconds(uint64_t ns);
+
+  node::Mutex _mutex;
+  uv_loop_t* _loop{nullptr};
+  uint64_t _startTime{0};
+  uint64_t _stopTime{0};
+  uint64_t _idleTime{0};
+  uint64_t _periodTime{0};
+  uint64_t _periodIdleTime{0};
+
+  std::shared_ptr<PoolingArrayBufferAllocator> _allocator;
+  uint64_t _periodAllocated{0};
+
+  std::atomic<std::size_t> _queueDepth{0};
+  std::atomic<std::size_t> _scriptsExecuted{0};
+
+  std::atomic<std::size_t> _heapTotal{0};
+  std::atomic<std::size_t> _heapUsed{0};
+  std::atomic<std::size_t> _heapLimit{0};
+  std::atomic<std::size_t> _externalMemory{0};
+
+  uint64_t _gcStartTime{0};
+  std::atomic<std::size_t> _gcCount{0};
+  std::atomic<uint64_t> _gcPauseTotal{0};
+  std::atomic<uint64_t> _gcPauseMax{0};
+
+  // Histogram has own lock
+  std::atomic<std::size_t> _latencyCount{0};
+  Histogram _latency;
+
+  struct Lane {
+    std::atomic<std::size_t> queueDepth{0};
+    std::atomic<std::size_t> dequeued{0};
+    std::atomic<std::size_t> queueTimeCount{0};
+    Histogram queueTime;
+  };
+  Lane _lanes[scriptPriorityCount];
+};
+
+
+inline void InstanceMetrics::start(uv_loop_t* loop, v8::Isolate* isolate, std::shared_ptr<PoolingArrayBufferAllocator> allocator) {
+  {
+    node::Mutex::ScopedLock lock{_mutex};
+    _loop = loop;
+    _startTime = ::uv_hrtime();
+    _periodTime = _startTime;
+    _periodIdleTime = ::uv_metrics_idle_time(loop);
+    _allocator = std::move(allocator);
+    _periodAllocated = _allocator->allocatedBytes();
+  }
+
+  isolate->AddGCPrologueCallback(gcPrologue, this);
+  isolate->AddGCEpilogueCallback(gcEpilogue, this);
+  sampleHeap(isolate);
+}
+
+inline void InstanceMetrics::stop(v8::Isolate* isolate) {
+  isolate->RemoveGCPrologueCallback(gcPrologue, this);
+  isolate->RemoveGCEpilogueCallback(gcEpilogue, this);
+
+  node::Mutex::ScopedLock lock{_mutex};
+  if (_loop == nullptr) {
+    return;
+  }
+  _idleTime = ::uv_metrics_idle_time(_loop);
+  _stopTime = ::uv_hrtime();
+  _loop = nullptr;
+}
+
+inline void InstanceMetrics::scriptQueued(ScriptPriority priority) {
+  ++_queueDepth;
+  ++(_lanes[static_cast<std::size_t>(priority)].queueDepth);
+}
+
+inline void InstanceMetrics::scriptDequeued(ScriptPriority priority, uint64_t queuedTime, uint64_t dequeueTime) {
+  --_queueDepth;
+
+  Lane& lane = _lanes[static_cast<std::size_t>(priority)];
+  --(lane.queueDepth);
+  ++(lane.dequeued);
+  ++(lane.queueTimeCount);
+  const int64_t queueTime = static_cast<int64_t>((dequeueTime - queuedTime) / 1000);
+  lane.queueTime.Record(queueTime > 0 ? queueTime : 1);
+}
+
+inline void InstanceMetrics::scriptDone(uint64_t queuedTime, uint64_t endTime) {
+  ++_scriptsExecuted;
+  ++_latencyCount;
+  // Histogram does not record values below lowest (1)
+  const int64_t latency = static_cast<int64_t>((endTime - queuedTime) / 1000);
+  _latency.Record(latency > 0 ? latency : 1);
+}
+
+inline void InstanceMetrics::sampleHeap(v8::Isolate* isolate) {
+  v8::HeapStatistics heapStatistics;
+  isolate->GetHeapStatistics(&heapStatistics);
+  _heapTotal = heapStatistics.total_heap_size();
+  _heapUsed = heapStatistics.used_heap_size();
+  _heapLimit = heapStatistics.heap_size_limit();
+  _externalMemory = heapStatistics.external_memory();
+}
+
+inline void InstanceMetrics::get(InstanceStats* stats) {
+  {
+    node::Mutex::ScopedLock lock{_mutex};
+    const uint64_t now = _loop != nullptr ? ::uv_hrtime() : _stopTime;
+    const uint64_t idleTime = _loop != nullptr ? ::uv_metrics_idle_time(_loop) : _idleTime;
+
+    if (_startTime != 0) {
+      const uint64_t totalTime = now - _startTime;
+      const uint64_t activeTime = totalTime > idleTime ? totalTime - idleTime : 0;
+      stats->loopIdleTime = toMicroseconds(idleTime);
+      stats->loopActiveTime = toMicroseconds(activeTime);
+
+      const uint64_t periodTime = now - _periodTime;
+      const uint64_t periodIdleTime = idleTime - _periodIdleTime;
+      if (periodTime != 0 && periodTime > periodIdleTime) {
+        stats->loopUtilization = static_cast<double>(periodTime - periodIdleTime) / static_cast<double>(periodTime);
+      }
+
+      _allocator->get(stats);
+      const uint64_t allocated = _allocator->allocatedBytes();
+      if (periodTime != 0) {
+        stats->arrayBufferAllocationRate = static_cast<double>(allocated - _periodAllocated) * 1e9 / static_cast<double>(periodTime);
+      }
+
+      _periodTime = now;
+      _periodIdleTime = idleTime;
+      _periodAllocated = allocated;
+    }
+
+    stats->latencyCount = _latencyCount.exchange(0);
+    if (stats->latencyCount != 0) {
+      stats->latencyP50 = std::chrono::microseconds{static_cast<int64_t>(_latency.Percentile(50))};
+      stats->latencyP90 = std::chrono::microseconds{static_cast<int64_t>(_latency.Percentile(90))};
+      stats->latencyP99 = std::chrono::microseconds{static_cast<int64_t>(_latency.Percentile(99))};
+      stats->latencyMax = std::chrono::microseconds{_latency.Max()};
+    }
+    _latency.Reset();
+
+    for (std::size_t i = 0; i < scriptPriorityCount; ++i) {
+      Lane& lane = _lanes[i];
+      LaneStats& laneStats = stats->lanes[i];
+      laneStats.queueTimeCount = lane.queueTimeCount.exchange(0);
+      if (laneStats.queueTimeCount != 0) {
+        laneStats.queueTimeP50 = std::chrono::microseconds{static_cast<int64_t>(lane.queueTime.Percentile(50))};
+        laneStats.queueTimeP99 = std::chrono::microseconds{static_cast<int64_t>(lane.queueTime.Percentile(99))};
+        laneStats.queueTimeMax = std::chrono::microseconds{lane.queueTime.Max()};
+      }
+      lane.queueTime.Reset();
+      laneStats.queueDepth = lane.queueDepth;
+      laneStats.scriptsDequeued = lane.dequeued;
+    }
+  }
+
+  stats->queueDepth = _queueDepth;
+  stats->scriptsExecuted = _scriptsExecuted;
+
+  stats->heapTotal = _heapTotal;
+  stats->heapUsed = _heapUsed;
+  stats->heapLimit = _heapLimit;
+  stats->externalMemory = _externalMemory;
+
+  stats->gcCount = _gcCount;
+  stats->gcPauseTotal = toMicroseconds(_gcPauseTotal);
+  stats->gcPauseMax = toMicroseconds(_gcPauseMax);
+}
+
+inline void InstanceMetrics::gcPrologue(v8::Isolate*, v8::GCType, v8::GCCallbackFlags, void* data) {
+  InstanceMetrics* metrics = static_cast<InstanceMetrics*>(data);
+  metrics->_gcStartTime = ::uv_hrtime();
+}
+
+inline void InstanceMetrics::gcEpilogue(v8::Isolate* isolate, v8::GCType, v8::GCCallbackFlags, void* data) {
+  InstanceMetrics* metrics = static_cast<InstanceMetrics*>(data);
+  if (metrics->_gcStartTime == 0) {
+    return;
+  }
+
+  const uint64_t pause = ::uv_hrtime() - metrics->_gcStartTime;
+  metrics->_gcStartTime = 0;
+  ++(metrics->_gcCount);
+  metrics->_gcPauseTotal += pause;
+  // Only instance thread writes maximum
+  if (pause > metrics->_gcPauseMax) {
+    metrics->_gcPauseMax = pause;
+  }
+
+  metrics->sampleHeap(isolate);
+}
+
+inline std::chrono::microseconds InstanceMetrics::toMicroseconds(uint64_t ns) {
+  return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::nanoseconds{ns});
+}
+
+
+} // namespace jscript
+} // namespace node
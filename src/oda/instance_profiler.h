@@ -0,0 +1,249 @@
+/*
+ * ODANT jscript, InstanceProfiler
+*/
+
+
+#pragma once
+
+
+#include "jscript.h"
+
+#include <v8.h>
+#include <v8-profiler.h>
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+
+namespace node {
+namespace jscript {
+
+
+// On-demand CPU profile and heap snapshot of instance isolate.
+// V8 CpuProfiler (with its sampling thread) exists only while profile is started.
+// Must be used only from instance thread while isolate is alive.
+
+class InstanceProfiler {
+public:
+  InstanceProfiler() = default;
+
+  InstanceProfiler(const InstanceProfiler&) = delete;
+  InstanceProfiler& operator=(const InstanceProfiler&) = delete;
+
+  bool isStarted() const;
+
+  bool start(v8::Isolate* isolate, std::chrono::microseconds samplingInterval);
+  // Profile in .cpuprofile JSON format, empty if profile is not started
+  std::string stop(v8::Isolate* isolate);
+  // Drops started profile, before isolate is disposed
+  void dispose(v8::Isolate* isolate);
+
+  // Snapshot in .heapsnapshot JSON format, written to sink by chunks
+  static bool writeHeapSnapshot(v8::Isolate* isolate, const HeapSnapshotSink& sink);
+
+private:
+  static v8::Local<v8::String> title(v8::Isolate* isolate);
+  static std::string serialize(v8::Isolate* isolate, const v8::CpuProfile* profile);
+  static void appendJsonString(std::string* out, const char* data, std::size_t length);
+
+  v8::CpuProfiler* _profiler{nullptr};
+};
+
+
+inline bool InstanceProfiler::isStarted() const {
+  return _profiler != nullptr;
+}
+
+inline bool InstanceProfiler::start(v8::Isolate* isolate, std::chrono::microseconds samplingInterval) {
+  if (_profiler != nullptr) {
+    return false;
+  }
+
+  v8::HandleScope handleScope{isolate};
+  _profiler = v8::CpuProfiler::New(isolate);
+  if (samplingInterval.count() > 0) {
+    _profiler->SetSamplingInterval(static_cast<int>(samplingInterval.count()));
+  }
+  _profiler->StartProfiling(title(isolate), true);
+  return true;
+}
+
+inline std::string InstanceProfiler::stop(v8::Isolate* isolate) {
+  if (_profiler == nullptr) {
+    return {};
+  }
+
+  v8::HandleScope handleScope{isolate};
+  v8::CpuProfile* profile = _profiler->StopProfiling(title(isolate));
+  std::string result;
+  if (profile != nullptr) {
+    result = serialize(isolate, profile);
+    profile->Delete();
+  }
+
+  _profiler->Dispose();
+  _profiler = nullptr;
+  return result;
+}
+
+inline void InstanceProfiler::dispose(v8::Isolate* isolate) {
+  if (_profiler == nullptr) {
+    return;
+  }
+
+  v8::HandleScope handleScope{isolate};
+  v8::CpuProfile* profile = _profiler->StopProfiling(title(isolate));
+  if (profile != nullptr) {
+    profile->Delete();
+  }
+
+  _profiler->Dispose();
+  _profiler = nullptr;
+}
+
+inline bool InstanceProfiler::writeHeapSnapshot(v8::Isolate* isolate, const HeapSnapshotSink& sink) {
+  class SinkStream : public v8::OutputStream {
+  public:
+    explicit SinkStream(const HeapSnapshotSink& sink) : _sink{sink} {}
+
+    int GetChunkSize() override {
+      return 64 * 1024;
+    }
+
+    void EndOfStream() override {
+      _isEnded = true;
+    }
+
+    WriteResult WriteAsciiChunk(char* data, int size) override {
+      return _sink(data, static_cast<std::size_t>(size)) ? kContinue : kAbort;
+    }
+
+    bool isEnded() const {
+      return _isEnded;
+    }
+
+  private:
+    const HeapSnapshotSink& _sink;
+    bool _isEnded{false};
+  };
+
+  v8::HandleScope handleScope{isolate};
+  const v8::HeapSnapshot* snapshot = isolate->GetHeapProfiler()->TakeHeapSnapshot();
+  if (snapshot == nullptr) {
+    return false;
+  }
+
+  SinkStream stream{sink};
+  snapshot->Serialize(&stream, v8::HeapSnapshot::kJSON);
+  const_cast<v8::HeapSnapshot*>(snapshot)->Delete();
+  return stream.isEnded();
+}
+
+inline v8::Local<v8::String> InstanceProfiler::title(v8::Isolate* isolate) {
+  return v8::String::NewFromUtf8Literal(isolate, "jscript");
+}
+
+inline std::string InstanceProfiler::serialize(v8::Isolate* isolate, const v8::CpuProfile* profile) {
+  std::string out;
+  out.append("{\"nodes\":[");
+
+  // Nodes are written in pre-order, children as ids
+  std::vector<const v8::CpuProfileNode*> pending{profile->GetTopDownRoot()};
+  bool isFirst = true;
+  while (!pending.empty()) {
+    const v8::CpuProfileNode* node = pending.back();
+    pending.pop_back();
+
+    if (!isFirst) {
+      out.append(1, ',');
+    }
+    isFirst = false;
+
+    out.append("{\"id\":").append(std::to_string(node->GetNodeId()));
+    out.append(",\"callFrame\":{\"functionName\":");
+    const char* functionName = node->GetFunctionNameStr();
+    appendJsonString(&out, functionName, std::strlen(functionName));
+    out.append(",\"scriptId\":\"").append(std::to_string(node->GetScriptId())).append("\",\"url\":");
+    v8::String::Utf8Value url{isolate, node->GetScriptResourceName()};
+    appendJsonString(&out, *url != nullptr ? *url : "", *url != nullptr ? url.length() : 0);
+    // V8 numbers are 1-based (0 - no info), DevTools ones are 0-based
+    out.append(",\"lineNumber\":").append(std::to_string(node->GetLineNumber() - 1));
+    out.append(",\"columnNumber\":").append(std::to_string(node->GetColumnNumber() - 1));
+    out.append("},\"hitCount\":").append(std::to_string(node->GetHitCount()));
+
+    const int childrenCount = node->GetChildrenCount();
+    if (childrenCount != 0) {
+      out.append(",\"children\":[");
+      for (int i = 0; i < childrenCount; ++i) {
+        if (i != 0) {
+          out.append(1, ',');
+        }
+        out.append(std::to_string(node->GetChild(i)->GetNodeId()));
+      }
+      out.append(1, ']');
+    }
+    out.append(1, '}');
+
+    for (int i = childrenCount - 1; i >= 0; --i) {
+      pending.push_back(node->GetChild(i));
+    }
+  }
+
+  out.append("],\"startTime\":").append(std::to_string(profile->GetStartTime()));
+  out.append(",\"endTime\":").append(std::to_string(profile->GetEndTime()));
+
+  const int samplesCount = profile->GetSamplesCount();
+  out.append(",\"samples\":[");
+  for (int i = 0; i < samplesCount; ++i) {
+    if (i != 0) {
+      out.append(1, ',');
+    }
+    out.append(std::to_string(profile->GetSample(i)->GetNodeId()));
+  }
+
+  out.append("],\"timeDeltas\":[");
+  int64_t lastTimestamp = profile->GetStartTime();
+  for (int i = 0; i < samplesCount; ++i) {
+    if (i != 0) {
+      out.append(1, ',');
+    }
+    const int64_t timestamp = profile->GetSampleTimestamp(i);
+    out.append(std::to_string(timestamp - lastTimestamp));
+    lastTimestamp = timestamp;
+  }
+  out.append("]}");
+
+  return out;
+}
+
+inline void InstanceProfiler::appendJsonString(std::string* out, const char* data, std::size_t length) {
+  out->append(1, '"');
+  for (std::size_t i = 0; i < length; ++i) {
+    const char c = data[i];
+    switch (c) {
+      case '"': out->append("\\\""); break;
+      case '\\': out->append("\\\\"); break;
+      case '\n': out->append("\\n"); break;
+      case '\r': out->append("\\r"); break;
+      case '\t': out->append("\\t"); break;
+      default: {
+        if (static_cast<unsigned char>(c) < 0x20) {
+          char escaped[8];
+          std::snprintf(escaped, sizeof(escaped), "\\u%04x", static_cast<unsigned>(c));
+          out->append(escaped);
+        }
+        else {
+          out->append(1, c);
+        }
+      } break;
+    }
+  }
+  out->append(1, '"');
+}
+
+
+} // namespace jscript
+} // namespace node
@@ -3,14 +3,25 @@
 #include "jscript.h"
 #include "executer_counter.h"
 #include "ref_counter.h"
+#include "mpsc_queue.h"
+#include "script_cache.h"
+#include "instance_metrics.h"
+#include "console_dispatcher.h"
+#include "callback_registry.h"
+#include "instance_profiler.h"
 
 #include "node_errors.h"
 #include "node_internals.h"
 #include "node_v8_platform-inl.h"
 #include "node_crypto.h"
+#include "node_buffer.h"
+#include "node_contextify.h"
+#include "node_messaging.h"
+#include "node_watchdog.h"
 #include "large_pages/node_large_page.h"
 
 #include <atomic>
+#include <climits>
 #include <cstring>
 #include <iostream>
 #include <memory>
@@ -22,6 +33,10 @@
 #include <condition_variable>
 #include <chrono>
 #include <optional>
+#include <deque>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
 
 
 namespace node {
@@ -34,6 +49,13 @@ std::atomic<bool> is_initilized{false};
 std::vector<std::string> args;
 std::vector<std::string> exec_args;
 
+std::atomic<std::size_t> script_cache_limit{256};
+
+// Scripts taken from each lane (ScriptPriority) per scheduling round,
+// rounds are repeated until lanes are empty or batch time is over
+constexpr std::size_t scriptLaneWeights[scriptPriorityCount] = {8, 4, 1};
+constexpr uint64_t scriptBatchTime = 10 * 1000 * 1000;  // ns
+
 
 class NodeInstanceData
 {
@@ -52,7 +74,7 @@ public:
 
 protected:
   std::unique_ptr<IsolateData> isolate_data_;
-  const bool deserialize_mode_ = false;
+  bool deserialize_mode_ = false;
 
 private:
   int exit_code_;
@@ -112,6 +134,223 @@ void NodeInstanceData::set_exit_code(int exit_code) {
 }
 
 
+// Startup snapshot blob file, written by node_mksnapshot --blob
+class StartupSnapshot {
+public:
+  StartupSnapshot() = default;
+
+  StartupSnapshot(const StartupSnapshot&) = delete;
+  StartupSnapshot& operator=(const StartupSnapshot&) = delete;
+
+  static StartupSnapshot& global();
+
+  bool load(const std::string& path);
+
+  v8::StartupData* blob();
+  const std::vector<size_t>* indexes();
+
+private:
+  std::vector<char> _data;
+  v8::StartupData _blob{nullptr, 0};
+  std::vector<size_t> _indexes;
+  bool _isLoaded{false};
+};
+
+
+StartupSnapshot& StartupSnapshot::global() {
+  static StartupSnapshot startupSnapshot{};
+  return startupSnapshot;
+}
+
+bool StartupSnapshot::load(const std::string& path) {
+  if (_isLoaded) {
+    return false;
+  }
+
+  FILE* file = ::fopen(path.c_str(), "rb");
+  if (file == nullptr) {
+    return false;
+  }
+  std::vector<char> data;
+  char buffer[64 * 1024];
+  for (std::size_t readed = ::fread(buffer, 1, sizeof(buffer), file); readed != 0; readed = ::fread(buffer, 1, sizeof(buffer), file)) {
+    data.insert(std::end(data), buffer, buffer + readed);
+  }
+  ::fclose(file);
+
+  static const char magic[] = "NODESNAP";
+  const std::size_t magicSize = sizeof(magic) - 1;
+  std::size_t offset = 0;
+
+  const auto readUint = [&data, &offset](auto* value) -> bool {
+    if (data.size() - offset < sizeof(*value)) {
+      return false;
+    }
+    std::memcpy(value, data.data() + offset, sizeof(*value));
+    offset += sizeof(*value);
+    return true;
+  };
+
+  if (data.size() < magicSize || std::memcmp(data.data(), magic, magicSize) != 0) {
+    return false;
+  }
+  offset += magicSize;
+
+  // Blob of other build fails fatally in V8, only same versions are accepted
+  const std::string version = std::string{NODE_VERSION} + " " + v8::V8::GetVersion();
+  uint32_t versionSize = 0;
+  if (!readUint(&versionSize) || versionSize != version.size() || data.size() - offset < versionSize ||
+      version.compare(0, versionSize, data.data() + offset, versionSize) != 0) {
+    return false;
+  }
+  offset += versionSize;
+
+  uint32_t blobSize = 0;
+  if (!readUint(&blobSize) || blobSize == 0 || blobSize > INT_MAX || data.size() - offset < blobSize) {
+    return false;
+  }
+  const std::size_t blobOffset = offset;
+  offset += blobSize;
+
+  // FNV-1a, same as node_mksnapshot
+  uint64_t checksum = 14695981039346656037ull;
+  for (std::size_t i = blobOffset; i < blobOffset + blobSize; ++i) {
+    checksum ^= static_cast<unsigned char>(data[i]);
+    checksum *= 1099511628211ull;
+  }
+  uint64_t blobChecksum = 0;
+  if (!readUint(&blobChecksum) || blobChecksum != checksum) {
+    return false;
+  }
+
+  uint32_t indexesCount = 0;
+  if (!readUint(&indexesCount) || (data.size() - offset) / sizeof(uint64_t) < indexesCount) {
+    return false;
+  }
+  std::vector<size_t> indexes;
+  indexes.reserve(indexesCount);
+  for (uint32_t i = 0; i < indexesCount; ++i) {
+    uint64_t index = 0;
+    if (!readUint(&index)) {
+      return false;
+    }
+    indexes.push_back(static_cast<size_t>(index));
+  }
+
+  _data = std::move(data);
+  _blob.data = _data.data() + blobOffset;
+  _blob.raw_size = static_cast<int>(blobSize);
+  _indexes = std::move(indexes);
+  _isLoaded = true;
+
+  return true;
+}
+
+v8::StartupData* StartupSnapshot::blob() {
+  if (_isLoaded) {
+    return &_blob;
+  }
+  return NodeMainInstance::GetEmbeddedSnapshotBlob();
+}
+
+const std::vector<size_t>* StartupSnapshot::indexes() {
+  if (_isLoaded) {
+    return &_indexes;
+  }
+  return NodeMainInstance::GetIsolateDataIndexes();
+}
+
+
+// Limits of running scripts, used only from instance thread
+struct ScriptLimits {
+  uint64_t timeout{0};  // ms, 0 - no deadline
+  bool running{false};  // queued script is in Run()
+  bool heapLimitReached{false};
+};
+
+
+// Lightweight context of instance (vm context), shares isolate, heap
+// and compiled scripts. Used only from instance thread.
+struct SubContext {
+  v8::Global<v8::Context> context;
+  v8::Global<v8::Object> sandbox;
+  CallbackRegistry callbacks;
+};
+
+// Native task is called with nullptr environment when instance is stopped
+using JSTask = std::function<void(Environment*)>;
+
+struct JSScriptJob : public MPSCNode
+{
+  std::string script;
+  std::vector<JSCallbackInfo> callbacks;
+  ScriptCompletion completion;
+  JSTask task;
+  uint64_t queuedTime{0};
+  uint64_t contextId{0};  // 0 - main context of instance
+  // Native tasks are control operations, run before queued scripts
+  ScriptPriority priority{ScriptPriority::Interactive};
+  // Runs after jobs queued before it in all lanes (stop script)
+  bool drain{false};
+  uint64_t drainCounts[scriptPriorityCount]{};  // jobs pushed to lanes before it
+
+  void cancel(const char* reason = "Instance is stopped");
+};
+
+inline void JSScriptJob::cancel(const char* reason) {
+  if (task) {
+    task(nullptr);
+  }
+  if (completion) {
+    ScriptResult result;
+    result.status = JS_ERROR;
+    result.exception = reason;
+    completion(std::move(result));
+  }
+}
+
+
+// libuv thread pool of group of instances, deleted with last reference,
+// after event loops of its instances are closed
+class JSThreadPoolImpl : public JSThreadPool, public RefCounter
+{
+public:
+  using Ptr = RefCounter::Ptr<JSThreadPoolImpl>;
+
+  explicit JSThreadPoolImpl(uv_threadpool_t* pool);
+  ~JSThreadPoolImpl();
+
+  static JSThreadPoolImpl::Ptr create(std::size_t threads);
+
+  uv_threadpool_t* pool() const;
+
+private:
+  uv_threadpool_t* const _pool;
+};
+
+
+inline JSThreadPoolImpl::JSThreadPoolImpl(uv_threadpool_t* pool)
+  :
+    _pool{pool}
+{}
+
+inline JSThreadPoolImpl::~JSThreadPoolImpl() {
+  CHECK_EQ(::uv_threadpool_delete(_pool), 0);
+}
+
+inline JSThreadPoolImpl::Ptr JSThreadPoolImpl::create(std::size_t threads) {
+  uv_threadpool_t* pool = nullptr;
+  if (::uv_threadpool_new(&pool, static_cast<unsigned int>(threads)) != 0) {
+    return JSThreadPoolImpl::Ptr{};
+  }
+  return JSThreadPoolImpl::Ptr{new JSThreadPoolImpl{pool}};
+}
+
+inline uv_threadpool_t* JSThreadPoolImpl::pool() const {
+  return _pool;
+}
+
+
 class JSInstanceImpl : public JSInstance, public RefCounter, public NodeInstanceData
 {
 private:
@@ -121,8 +360,10 @@ public:
   using Ptr = RefCounter::Ptr<JSInstanceImpl>;
 
   JSInstanceImpl(CtorTag);
+  ~JSInstanceImpl();
 
   static JSInstanceImpl::Ptr create();
+  static JSInstanceImpl::Ptr create(const InstanceOptions& options);
 
 #ifdef ERROR
   #undef ERROR
@@ -133,6 +374,11 @@ public:
 
   void StartNodeInstance();
 
+  // Steps of StartNodeInstance, for instances driven by shared loop workers
+  bool setupNodeInstance();
+  bool runNodeInstance(uv_run_mode mode);
+  void teardownNodeInstance();
+
   bool isStopping() const;
   bool isStop() const;
   bool isError() const;
@@ -140,10 +386,37 @@ public:
   bool isInitialize() const;
 
   void setState(state_t state);
+  // Interrupts running script and stops event loop, from any thread
+  void terminate();
+  uint64_t stopTime() const;
 
   void SetConsoleCallback(ConsoleCallback cb);
   const std::optional<ConsoleCallback>& GetConsoleCallback();
 
+  // Only from instance thread
+  void setConsoleSink(std::shared_ptr<ConsoleSink> sink);
+  const std::shared_ptr<ConsoleSink>& consoleSink() const;
+
+  uint64_t id() const;
+
+  // nullptr - process-wide pool
+  uv_threadpool_t* threadPool();
+
+  bool postScript(std::unique_ptr<JSScriptJob> job);
+  bool postTask(JSTask task);
+  // Stop script, runs after scripts queued before it
+  bool postStopScript();
+  void executeScripts();
+  void executeScript(Environment* env, std::unique_ptr<JSScriptJob> job);
+
+  // Only from instance thread
+  void bindCallbacks(v8::Local<v8::Context> context, const std::vector<JSCallbackInfo>& callbacks);
+
+  uint64_t newSubContextId();
+  bool createSubContext(Environment* env, uint64_t id);
+  void destroySubContext(uint64_t id);
+  SubContext* subContext(uint64_t id);
+
   static const std::string defaultOrigin;
   static const std::string externalOrigin;
   static const std::string stopScript;
@@ -151,11 +424,14 @@ public:
   Mutex _isolate_mutex;
   v8::Isolate* _isolate{nullptr};
   Environment* _env{nullptr};
-  std::thread _thread;
 
   std::mutex _state_mutex;
   std::condition_variable _state_cv;
 
+  InstanceMetrics _metrics;
+  // Only from instance thread
+  InstanceProfiler _profiler;
+
 private:
   DeleteFnPtr<Environment, FreeEnvironment> CreateEnvironment(int*);
 
@@ -167,9 +443,61 @@ private:
   void overrideConsole(v8::Local<v8::Context>);
   void overrideConsole(v8::Local<v8::Context>, const char* name, const ConsoleType type);
 
+  void initScriptQueue();
+  void closeScriptQueue();
+
+  void keepAlive();
+  void initIdleTimer();
+  void closeIdleTimer();
+  void touchIdleTimer();
+  static void onIdle(uv_timer_t* handle);
+
+  static size_t nearHeapLimit(void* data, size_t currentHeapLimit, size_t initialHeapLimit);
+
   std::atomic<state_t> _state = ATOMIC_VAR_INIT(CREATE);
+  std::atomic<uint64_t> _stop_time{0};
+
+  InstanceOptions _options;
+  ScriptLimits _script_limits;
+
+  // Set before instance is started, released after event loop is closed
+  JSThreadPoolImpl::Ptr _thread_pool;
+
+  DeleteFnPtr<Environment, FreeEnvironment> _env_holder;
+  int _setup_exit_code{0};
+
+  // Single async handle per instance, wakes the loop for all queued scripts
+  uv_async_t _script_async;
+  MPSCQueue<JSScriptJob> _script_queues[scriptPriorityCount];
+  std::atomic<bool> _script_queue_closed{true};
+  std::atomic<std::size_t> _script_senders{0};
+  // Jobs pushed to and taken from lanes, for drain jobs
+  std::atomic<uint64_t> _script_pushed[scriptPriorityCount]{};
+  uint64_t _script_taken[scriptPriorityCount]{};  // only from instance thread
+  std::vector<std::unique_ptr<JSScriptJob>> _drain_jobs;  // only from instance thread
+
+  // Hibernation of idle instance, only from instance thread
+  uv_timer_t _idle_timer;
+  bool _is_idle_timer{false};
+  bool _is_idle{false};
+
+  ScriptCache _script_cache;
+  CallbackRegistry _callbacks;
+
+  std::unordered_map<uint64_t, std::unique_ptr<SubContext>> _sub_contexts;
+  std::atomic<uint64_t> _sub_context_last_id{0};
+
+  // Data of console override functions, reused by console of sub contexts
+  struct ConsoleMethod {
+    std::string name;
+    v8::Global<v8::Array> data;
+  };
+  std::vector<ConsoleMethod> _console_methods;
 
   std::optional<ConsoleCallback> _consoleCallback;
+  std::shared_ptr<ConsoleSink> _console_sink;
+
+  const uint64_t _id;
 };
 
 
@@ -178,15 +506,91 @@ const std::string JSInstanceImpl::externalOrigin;
 const std::string JSInstanceImpl::stopScript;
 
 
+namespace {
+
+std::atomic<uint64_t> instance_last_id{0};
+
+} // Anonymous namespace
+
+
+// Instances with running environment, stopped by Uninitilize() with grace period
+
+class RunningInstances {
+public:
+  static RunningInstances& global();
+
+  void add(JSInstanceImpl* instance);
+  void remove(JSInstanceImpl* instance);
+  std::vector<JSInstanceImpl::Ptr> list();
+
+private:
+  std::mutex _mutex;
+  std::unordered_set<JSInstanceImpl*> _instances;
+};
+
+RunningInstances& RunningInstances::global() {
+  static RunningInstances runningInstances{};
+  return runningInstances;
+}
+
+void RunningInstances::add(JSInstanceImpl* instance) {
+  std::unique_lock<std::mutex> lock{_mutex};
+  _instances.insert(instance);
+}
+
+void RunningInstances::remove(JSInstanceImpl* instance) {
+  std::unique_lock<std::mutex> lock{_mutex};
+  _instances.erase(instance);
+}
+
+std::vector<JSInstanceImpl::Ptr> RunningInstances::list() {
+  // Instance thread holds reference until instance is removed
+  std::unique_lock<std::mutex> lock{_mutex};
+  return std::vector<JSInstanceImpl::Ptr>(std::begin(_instances), std::end(_instances));
+}
+
+
 inline JSInstanceImpl::JSInstanceImpl(JSInstanceImpl::CtorTag)
+  :
+    _id{++instance_last_id}
 {}
 
+inline JSInstanceImpl::~JSInstanceImpl() {
+  for (auto& queue : _script_queues) {
+    while (JSScriptJob* job = queue.pop()) {
+      job->cancel();
+      delete job;
+    }
+  }
+
+  // Unbinds loop from thread pool before pool is released
+  close_loop();
+}
+
 inline JSInstanceImpl::Ptr JSInstanceImpl::create() {
   return JSInstanceImpl::Ptr{
     new JSInstanceImpl{CtorTag{}}
   };
 }
 
+inline JSInstanceImpl::Ptr JSInstanceImpl::create(const InstanceOptions& options) {
+  JSInstanceImpl::Ptr instance = create();
+  instance->_options = options;
+  instance->_script_limits.timeout = static_cast<uint64_t>(options.scriptTimeout.count());
+
+  if (options.threadPool != nullptr) {
+    instance->_thread_pool = JSThreadPoolImpl::Ptr{static_cast<JSThreadPoolImpl*>(options.threadPool)};
+  }
+  else if (options.threadPoolSize != 0) {
+    instance->_thread_pool = JSThreadPoolImpl::create(options.threadPoolSize);
+  }
+  if (instance->_thread_pool) {
+    CHECK_EQ(::uv_loop_set_threadpool(instance->event_loop(), instance->_thread_pool->pool()), 0);
+  }
+
+  return instance;
+}
+
 bool JSInstanceImpl::isStopping() const {
   const bool envStopped = !(_env && _env->is_stopping());
   return _state == JSInstanceImpl::state_t::STOPPING || envStopped;
@@ -212,11 +616,25 @@ bool JSInstanceImpl::isInitialize() const {
 void JSInstanceImpl::setState(state_t state) {
   {
     std::unique_lock<std::mutex> lock(_state_mutex);
+    if (state == state_t::STOP) {
+      _stop_time = ::uv_hrtime();
+    }
     _state = state;
   }
   _state_cv.notify_all();
 }
 
+void JSInstanceImpl::terminate() {
+  Environment* env = _env;
+  if (env != nullptr && !env->is_stopping()) {
+    env->ExitEnv();
+  }
+}
+
+uint64_t JSInstanceImpl::stopTime() const {
+  return _stop_time;
+}
+
 const std::optional<ConsoleCallback>& JSInstanceImpl::GetConsoleCallback() {
   return _consoleCallback;
 }
@@ -225,6 +643,28 @@ void JSInstanceImpl::SetConsoleCallback(ConsoleCallback cb) {
   _consoleCallback = std::move(cb);
 }
 
+void JSInstanceImpl::setConsoleSink(std::shared_ptr<ConsoleSink> sink) {
+  if (_console_sink && _console_sink->isBatched()) {
+    ConsoleDispatcher::global().remove(_console_sink);
+  }
+  _console_sink = std::move(sink);
+  if (_console_sink && _console_sink->isBatched()) {
+    ConsoleDispatcher::global().add(_console_sink);
+  }
+}
+
+const std::shared_ptr<ConsoleSink>& JSInstanceImpl::consoleSink() const {
+  return _console_sink;
+}
+
+uint64_t JSInstanceImpl::id() const {
+  return _id;
+}
+
+uv_threadpool_t* JSInstanceImpl::threadPool() {
+  return _thread_pool ? _thread_pool->pool() : nullptr;
+}
+
 
 JSInstanceImpl::AutoResetState JSInstanceImpl::createAutoReset(state_t state) {
   const auto deleter = [that = JSInstanceImpl::Ptr{ this }, state](void*) {
@@ -237,29 +677,59 @@ JSInstanceImpl::AutoResetState JSInstanceImpl::createAutoReset(state_t state) {
 void JSInstanceImpl::StartNodeInstance() {
   auto autoResetState = createAutoReset(state_t::STOP);
 
+  if (setupNodeInstance()) {
+    while (runNodeInstance(UV_RUN_DEFAULT)) {}
+  }
+
+  teardownNodeInstance();
+}
+
+bool JSInstanceImpl::setupNodeInstance() {
   v8::Isolate::CreateParams params;
-  auto allocator = ArrayBufferAllocator::Create();
+  auto allocator = std::make_shared<PoolingArrayBufferAllocator>(_options.maxArrayBufferMemory, _options.arrayBufferPoolSize);
   MultiIsolatePlatform* platform = per_process::v8_platform.Platform();
 
+  // Following code from node::Start
+
+  const std::vector<size_t>* indexes = nullptr;
+  static const intptr_t externalReferences[] = { reinterpret_cast<intptr_t>(nullptr) };
+  if (per_process::cli_options->per_isolate->node_snapshot) {
+    v8::StartupData* blob = StartupSnapshot::global().blob();
+    if (blob != nullptr) {
+      params.external_references = externalReferences;
+      params.snapshot_blob = blob;
+      indexes = StartupSnapshot::global().indexes();
+    }
+  }
+
   // Following code from NodeMainInstance::NodeMainInstance
 
+  // Backing stores passed to host keep allocator alive after isolate dispose
   params.array_buffer_allocator = allocator.get();
+  params.array_buffer_allocator_shared = allocator;
   _isolate = v8::Isolate::Allocate();
   CHECK_NOT_NULL(_isolate);
   // Register the isolate on the platform before the isolate gets initialized,
   // so that the isolate can access the platform during initialization.
   platform->RegisterIsolate(_isolate, event_loop());
   SetIsolateCreateParamsForNode(&params);
+  if (_options.maxHeapSize != 0) {
+    params.constraints.ConfigureDefaultsFromHeapSize(_options.initialHeapSize, _options.maxHeapSize);
+  }
   v8::Isolate::Initialize(_isolate, params);
+  if (_options.maxHeapSize != 0) {
+    _isolate->AddNearHeapLimitCallback(nearHeapLimit, this);
+    _isolate->AutomaticallyRestoreInitialHeapLimit();
+  }
 
-  // deserialize_mode_ = per_isolate_data_indexes != nullptr;
+  deserialize_mode_ = indexes != nullptr;
   // If the indexes are not nullptr, we are not deserializing
-  //CHECK_IMPLIES(deserialize_mode_, params.external_references != nullptr);
+  CHECK_IMPLIES(deserialize_mode_, params.external_references != nullptr);
   {
     // ctor IsolateData call Isolate::GetCurrent, need enter
     v8::Locker locker{ _isolate };
     isolate_data_ = std::make_unique<IsolateData>(
-      _isolate, event_loop(), platform, allocator.get());
+      _isolate, event_loop(), platform, allocator.get(), indexes);
   }
 
   IsolateSettings s;
@@ -270,72 +740,118 @@ void JSInstanceImpl::StartNodeInstance() {
     SetIsolateErrorHandlers(_isolate, s);
   }
 
+  initScriptQueue();
+  initIdleTimer();
+  _metrics.start(event_loop(), _isolate, allocator);
+
   // Following code from NodeMainInstance::Run
 
-  int exit_code = 0;
-  {
-    v8::Locker locker{_isolate};
-    v8::Isolate::Scope isolateScope{_isolate};
-    v8::HandleScope handleScope{_isolate};
+  v8::Locker locker{_isolate};
+  v8::Isolate::Scope isolateScope{_isolate};
+  v8::HandleScope handleScope{_isolate};
+
+  _env_holder = this->CreateEnvironment(&_setup_exit_code);
+  CHECK(_env_holder);
+  _env = _env_holder.get();
+  RunningInstances::global().add(this);
+  if (_setup_exit_code != 0) {
+    return false;
+  }
 
-    auto env = this->CreateEnvironment(&exit_code);
-    CHECK(env);
-    _env = env.get();
+  v8::Local<v8::Context> context = _env->context();
+  v8::Context::Scope contextScope{context};
 
-    v8::Local<v8::Context> context = env->context();
-    v8::Context::Scope contextScope{context};
-    if (exit_code == 0) {
-      LoadEnvironment(env.get());
-      this->overrideConsole(context);
+  LoadEnvironment(_env);
+  this->overrideConsole(context);
 
-      env->set_trace_sync_io(env->options()->trace_sync_io);
+  _env->set_trace_sync_io(_env->options()->trace_sync_io);
+  _env->performance_state()->Mark(node::performance::NODE_PERFORMANCE_MILESTONE_LOOP_START);
 
-      {
-        v8::SealHandleScope seal(_isolate);
-        bool more;
-        env->performance_state()->Mark(node::performance::NODE_PERFORMANCE_MILESTONE_LOOP_START);
+  return true;
+}
 
-        do {
-          uv_run(env->event_loop(), UV_RUN_DEFAULT);
+bool JSInstanceImpl::runNodeInstance(uv_run_mode mode) {
+  // Isolate may be driven by different threads between runs (shared loop workers)
+  v8::Locker locker{_isolate};
+  v8::Isolate::Scope isolateScope{_isolate};
+  v8::HandleScope handleScope{_isolate};
+  v8::Context::Scope contextScope{_env->context()};
+  v8::SealHandleScope seal(_isolate);
 
-          per_process::v8_platform.DrainVMTasks(_isolate);
+  uv_loop_t* loop = _env->event_loop();
+  uv_run(loop, mode);
 
+  // Draining blocks on background tasks of all isolates, only before exit
+  if (mode == UV_RUN_NOWAIT && uv_loop_alive(loop) && !_env->is_stopping()) {
+    return true;
+  }
 
-          more = uv_loop_alive(env->event_loop());
-          if (more && !env->is_stopping()) {
-            continue;
-          }
+  per_process::v8_platform.DrainVMTasks(_isolate);
 
-          if (!uv_loop_alive(env->event_loop())) {
-            EmitBeforeExit(env.get());
-          }
+  bool more = uv_loop_alive(loop);
+  if (more && !_env->is_stopping()) {
+    return true;
+  }
 
-          // Emit `beforeExit` if the loop became alive either after emitting
-          // event, or after running some callbacks.
-          more = uv_loop_alive(env->event_loop());
-        } while (more == true && !env->is_stopping());
+  if (!uv_loop_alive(loop)) {
+    EmitBeforeExit(_env);
+  }
 
-        env->performance_state()->Mark(node::performance::NODE_PERFORMANCE_MILESTONE_LOOP_EXIT);
-      }
+  // Emit `beforeExit` if the loop became alive either after emitting
+  // event, or after running some callbacks.
+  more = uv_loop_alive(loop);
+  return more && !_env->is_stopping();
+}
+
+void JSInstanceImpl::teardownNodeInstance() {
+  MultiIsolatePlatform* platform = per_process::v8_platform.Platform();
+
+  RunningInstances::global().remove(this);
+
+  int exit_code = _setup_exit_code;
+  {
+    v8::Locker locker{_isolate};
+    v8::Isolate::Scope isolateScope{_isolate};
+    v8::HandleScope handleScope{_isolate};
+
+    if (exit_code == 0) {
+      v8::Context::Scope contextScope{_env->context()};
+
+      _env->performance_state()->Mark(node::performance::NODE_PERFORMANCE_MILESTONE_LOOP_EXIT);
 
-      env->set_trace_sync_io(false);
+      _env->set_trace_sync_io(false);
 
       // Disabling validation due to ContextifyScript (comment MakeWeak() in constructor)
       //if (!env->is_stopping()) env->VerifyNoStrongBaseObjects();
 
-      exit_code = EmitExit(env.get());
+      exit_code = EmitExit(_env);
     }
 
+    closeScriptQueue();
+    closeIdleTimer();
+    _script_cache.clear();
+    _callbacks.clear();
+    _sub_contexts.clear();
+    _console_methods.clear();
+    _metrics.stop(_isolate);
+    _profiler.dispose(_isolate);
+    setConsoleSink(nullptr);
+
     ResetStdio();
 
 #if defined(LEAK_SANITIZER)
     __lsan_do_leak_check();
 #endif
+
+    _env_holder.reset();
   }
   set_exit_code(exit_code);
   _env = nullptr;
 
   platform->DrainTasks(_isolate);
+  if (_options.maxHeapSize != 0) {
+    _isolate->RemoveNearHeapLimitCallback(nearHeapLimit, 0);
+  }
   platform->UnregisterIsolate(_isolate);
   _isolate->Dispose();
 
@@ -343,6 +859,26 @@ void JSInstanceImpl::StartNodeInstance() {
   close_loop();
 }
 
+size_t JSInstanceImpl::nearHeapLimit(void* data, size_t currentHeapLimit, size_t initialHeapLimit) {
+  JSInstanceImpl* instance = static_cast<JSInstanceImpl*>(data);
+  CHECK_NOT_NULL(instance);
+
+  // Fail running script instead of OOM crash of whole process
+  if (instance->_script_limits.running) {
+    instance->_script_limits.heapLimitReached = true;
+    instance->_isolate->TerminateExecution();
+  }
+  // Timers, I/O and promise callbacks are not part of queued script, instance is stopped
+  else if (!instance->isError()) {
+    instance->setState(state_t::ERROR);
+    instance->terminate();
+  }
+
+  // Headroom for unwinding is granted once, up to 1.25 of initial limit. Initial limit
+  // is restored after garbage is collected, further growth fails with OOM of V8
+  return std::max(currentHeapLimit, initialHeapLimit + initialHeapLimit / 4);
+}
+
 DeleteFnPtr<Environment, FreeEnvironment> JSInstanceImpl::CreateEnvironment(
       int* exit_code) {
     *exit_code = 0;  // Reset the exit code to 0
@@ -389,6 +925,8 @@ DeleteFnPtr<Environment, FreeEnvironment> JSInstanceImpl::CreateEnvironment(
     const std::string externalOriginName{ "EXTERNALORIGIN" };
     addGlobalStringValue(context, externalOriginName, externalOrigin);
 
+    bindCallbacks(context, CallbackRegistry::globalCallbacks());
+
     // TODO(joyeecheung): when we snapshot the bootstrapped context,
     // the inspector and diagnostics setup should after after deserialization.
 #if HAVE_INSPECTOR
@@ -444,7 +982,11 @@ void JSInstanceImpl::addSetState(v8::Local<v8::Context> context, const char* nam
           DCHECK_NOT_NULL(instance);
 
           v8::Local<v8::Int32> stateCode = array->Get(context, 1).ToLocalChecked().As<v8::Int32>();
-          instance->setState(static_cast<JSInstanceImpl::state_t>(stateCode-> Value()));
+          const auto state = static_cast<JSInstanceImpl::state_t>(stateCode-> Value());
+          if (state == JSInstanceImpl::RUN) {
+            instance->keepAlive();
+          }
+          instance->setState(state);
     };  // callback
 
     v8::Local<v8::External> instanceExt = v8::External::New(_isolate, this);
@@ -493,18 +1035,34 @@ void JSInstanceImpl::overrideConsole(v8::Local<v8::Context> context, const char*
 
   //TODO: add check re-override control
 
-  v8::Local<v8::Array> array = v8::Array::New(_isolate, 3);
+  v8::Local<v8::Array> array = v8::Array::New(_isolate, 4);
 
   v8::Local<v8::Value> globalMethod = globalConsoleObj->Get(context, methodName).ToLocalChecked().As<v8::Function>();
   v8::Local<v8::External> instanceExt = v8::External::New(_isolate, this);
   v8::Local<v8::External> typeExt = v8::External::New(_isolate, reinterpret_cast<void*>(type));
 
+  // util.format() for console sink, same formatting as node console
+  v8::Local<v8::Value> formatFunction = v8::Undefined(_isolate);
+  {
+    v8::TryCatch tryCatch{_isolate};
+    v8::Local<v8::Value> utilName = v8::String::NewFromUtf8(_isolate, "util").ToLocalChecked();
+    v8::Local<v8::Value> util;
+    if (_env->native_module_require()->Call(context, v8::Null(_isolate), 1, &utilName).ToLocal(&util) && util->IsObject()) {
+      v8::Local<v8::String> formatName = v8::String::NewFromUtf8(_isolate, "format").ToLocalChecked();
+      if (!util.As<v8::Object>()->Get(context, formatName).ToLocal(&formatFunction)) {
+        formatFunction = v8::Undefined(_isolate);
+      }
+    }
+  }
+
   array->Set(context, 0, globalMethod).Check();
   array->Set(context, 1, instanceExt).Check();
   array->Set(context, 2, typeExt).Check();
+  array->Set(context, 3, formatFunction).Check();
 
   v8::Local<v8::Function> overrideFunction = v8::Function::New(context, consoleCallback, array).ToLocalChecked();
   globalConsoleObj->Set(context, methodName, overrideFunction).Check();
+  _console_methods.push_back(ConsoleMethod{name, v8::Global<v8::Array>{_isolate, array}});
 
   v8::Local<v8::String> odantFrameworkName = v8::String::NewFromUtf8(_isolate, "odantFramework").ToLocalChecked();
   v8::Local<v8::Value> odantFramework = globalObj->Get(context, odantFrameworkName).ToLocalChecked();
@@ -556,17 +1114,44 @@ void consoleCallback(const v8::FunctionCallbackInfo<v8::Value>& args) {
         info.push_back(args[i]);
     }
 
-    globalLogFunc->Call(context, v8::Null(isolate), info.size(), info.data()).ToLocalChecked();
-
     v8::Local<v8::External> instanceExt = array->Get(context, 1).ToLocalChecked().As<v8::External>();
     JSInstanceImpl* instance = reinterpret_cast<JSInstanceImpl*>(instanceExt->Value());
     DCHECK_NOT_NULL(instance);
 
+    v8::Local<v8::External> typeExt = array->Get(context, 2).ToLocalChecked().As<v8::External>();
+    auto type = static_cast<ConsoleType>(reinterpret_cast<std::size_t>(typeExt->Value()));
+
+    const std::shared_ptr<ConsoleSink>& consoleSink = instance->consoleSink();
+    if (consoleSink) {
+        // Format once, node console is not called
+        v8::Local<v8::Value> formatFunc = array->Get(context, 3).ToLocalChecked();
+        v8::Local<v8::Value> formatted;
+        if (formatFunc->IsFunction()) {
+            if (!formatFunc.As<v8::Function>()->Call(context, v8::Null(isolate), info.size(), info.data()).ToLocal(&formatted)) {
+                return;
+            }
+        }
+        else if (!info.empty()) {
+            formatted = info.front();
+        }
+
+        std::string text;
+        if (!formatted.IsEmpty()) {
+            v8::String::Utf8Value utf8{isolate, formatted};
+            if (*utf8 != nullptr) {
+                text.assign(*utf8, utf8.length());
+            }
+        }
+        if (consoleSink->write(type, std::move(text))) {
+            ConsoleDispatcher::global().wakeup();
+        }
+    }
+    else {
+        globalLogFunc->Call(context, v8::Null(isolate), info.size(), info.data()).ToLocalChecked();
+    }
+
     const std::optional<ConsoleCallback>& consoleCallback = instance->GetConsoleCallback();
     if (consoleCallback) {
-        v8::Local<v8::External> typeExt = array->Get(context, 2).ToLocalChecked().As<v8::External>();
-        auto type = static_cast<ConsoleType>(reinterpret_cast<std::size_t>(typeExt->Value()));
-
         consoleCallback->operator()(args, type);
     }
 }
@@ -816,12 +1401,6 @@ std::string getInitScript(std::string odaFrameworkPath) {
 #endif
     "global.odantFramework = require('" + odaFrameworkPath + "');\n"
     "global.odantFramework.then(core => {\n"
-    "  var infiniteFunction = function() {\n"
-    "    setTimeout(function() {\n"
-    "        infiniteFunction();\n"
-    "    }, 1000);\n"
-    "  };\n"
-    "  infiniteFunction();\n"
     "  console.log('framework loaded!');\n"
 #ifdef _DEBUG
     "  console.log('core.DEFAULTORIGIN=%s', core.DEFAULTORIGIN);\n"
@@ -907,156 +1486,1195 @@ NODE_EXTERN void SetConsoleCallback(JSInstance* instance, ConsoleCallback cb) {
   instanceImpl->SetConsoleCallback(std::move(cb));
 }
 
-NODE_EXTERN void Uninitilize() {
-  if (!is_initilized.exchange(false)) {
-    return;
-  }
+class InstancePool {
+public:
+  InstancePool() = default;
 
-  ExecutorCounter::global().waitAllStop();
+  InstancePool(const InstancePool&) = delete;
+  InstancePool& operator=(const InstancePool&) = delete;
 
-  TearDownOncePerProcess();
-}
+  static InstancePool& global();
 
-NODE_EXTERN result_t CreateInstance(JSInstance** outNewInstance) {
-  JSInstanceImpl::Ptr instance = JSInstanceImpl::create();
-  if (!instance) return JS_ERROR;
+  void setSize(std::size_t size);
+  JSInstanceImpl::Ptr acquire();
+  InstancePoolStats stats();
+  void shutdown();
 
-  instance->_thread = std::thread([instance]() {
-    ExecutorCounter::ScopeExecute scopeExecute;
-    instance->StartNodeInstance();
-    instance->_thread.detach();
-  });
+  void launch(JSInstanceImpl::Ptr instance);
 
-  const auto timeout = std::chrono::seconds(30);
-  std::unique_lock<std::mutex> lock(instance->_state_mutex);
-  while (!instance->isInitialize()) {
-      if (instance->_state_cv.wait_for(lock, timeout) ==  std::cv_status::timeout) {
-          instance->setState(JSInstanceImpl::TIMEOUT);
-      }
-  }
+private:
+  static void runThread(JSInstanceImpl::Ptr instance);
+  JSInstanceImpl::Ptr park();
+  void refill();
 
-  *outNewInstance = instance.detach();
+  // How long finished instance thread waits for next instance
+  static constexpr std::chrono::seconds parkTimeout{10};
 
-  return JS_SUCCESS;
-}
+  std::mutex _mutex;
+  std::condition_variable _refill_cv;
+  std::condition_variable _park_cv;
 
+  std::size_t _size{0};
+  std::size_t _starting{0};
+  std::deque<JSInstanceImpl::Ptr> _ready;
+  std::thread _refill_thread;
+  bool _stop{false};
 
-NODE_EXTERN result_t StopInstance(JSInstance* instance_) {
-    if (instance_ == nullptr)
-        return JS_ERROR;
+  std::size_t _parked{0};
+  std::deque<JSInstanceImpl::Ptr> _handoff;
 
-    JSInstanceImpl::Ptr instance;
-    instance.adopt(static_cast<JSInstanceImpl*>(instance_));
-    if (!instance->isStop()) {
-        assert(!JSInstanceImpl::stopScript.empty());
-        RunScriptText(instance_, JSInstanceImpl::stopScript);
-        std::unique_lock<std::mutex> lock(instance->_state_mutex);
-        const auto timeout = std::chrono::seconds(30);
-        while (true) {
-            if (instance->isStop())
-                break;
-            if (instance->isError()) {
-                auto env = instance->_env;
-                if (env != nullptr && !env->is_stopping())
-                    env->ExitEnv();
-            }
-            const auto waitStatus = instance->_state_cv.wait_for(lock, timeout);
-            if (waitStatus == std::cv_status::timeout) {
-                auto env = instance->_env;
-                if (env != nullptr && !env->is_stopping())
-                    env->ExitEnv();
-            }
-        }
-    }
+  std::size_t _hits{0};
+  std::size_t _misses{0};
+  std::size_t _recycled{0};
+};
 
-    return JS_SUCCESS;
-}
 
+constexpr std::chrono::seconds InstancePool::parkTimeout;
 
-namespace {
+InstancePool& InstancePool::global() {
+  static InstancePool instancePool{};
+  return instancePool;
+}
 
+void InstancePool::setSize(std::size_t size) {
+  std::deque<JSInstanceImpl::Ptr> excess;
+  {
+    std::unique_lock<std::mutex> lock{_mutex};
+    if (_stop) {
+      return;
+    }
+    _size = size;
+    while (_ready.size() > _size) {
+      excess.push_back(std::move(_ready.back()));
+      _ready.pop_back();
+    }
+    if (_size != 0 && !_refill_thread.joinable()) {
+      _refill_thread = std::thread([this]() { refill(); });
+    }
+  }
+  _refill_cv.notify_all();
+
+  for (JSInstanceImpl::Ptr& instance : excess) {
+    StopInstance(instance.detach());
+  }
+}
+
+JSInstanceImpl::Ptr InstancePool::acquire() {
+  JSInstanceImpl::Ptr instance;
+  std::deque<JSInstanceImpl::Ptr> dead;
+  {
+    std::unique_lock<std::mutex> lock{_mutex};
+    while (!_ready.empty()) {
+      JSInstanceImpl::Ptr ready = std::move(_ready.front());
+      _ready.pop_front();
+      if (ready->isRun()) {
+        instance = std::move(ready);
+        break;
+      }
+      // Died while waiting in pool
+      dead.push_back(std::move(ready));
+    }
+    if (instance) {
+      ++_hits;
+    }
+    else {
+      ++_misses;
+    }
+  }
+  _refill_cv.notify_all();
+
+  for (JSInstanceImpl::Ptr& deadInstance : dead) {
+    StopInstance(deadInstance.detach());
+  }
+
+  return instance;
+}
+
+InstancePoolStats InstancePool::stats() {
+  std::unique_lock<std::mutex> lock{_mutex};
+
+  InstancePoolStats stats;
+  stats.size = _size;
+  stats.ready = _ready.size();
+  stats.starting = _starting;
+  stats.parkedThreads = _parked;
+  stats.hits = _hits;
+  stats.misses = _misses;
+  stats.recycledThreads = _recycled;
+  return stats;
+}
+
+void InstancePool::shutdown() {
+  std::deque<JSInstanceImpl::Ptr> ready;
+  {
+    std::unique_lock<std::mutex> lock{_mutex};
+    _stop = true;
+    _size = 0;
+    ready.swap(_ready);
+  }
+  _refill_cv.notify_all();
+  _park_cv.notify_all();
+
+  if (_refill_thread.joinable()) {
+    _refill_thread.join();
+  }
+
+  std::vector<JSInstance*> instances;
+  for (JSInstanceImpl::Ptr& instance : ready) {
+    instances.push_back(instance.detach());
+  }
+  StopInstances(instances, defaultStopGracePeriod);
+}
+
+void InstancePool::launch(JSInstanceImpl::Ptr instance) {
+  {
+    std::unique_lock<std::mutex> lock{_mutex};
+    if (_handoff.size() < _parked) {
+      _handoff.push_back(std::move(instance));
+      ++_recycled;
+    }
+  }
+
+  if (instance) {
+    std::thread(runThread, std::move(instance)).detach();
+  }
+  else {
+    _park_cv.notify_one();
+  }
+}
+
+void InstancePool::runThread(JSInstanceImpl::Ptr instance) {
+  ExecutorCounter::ScopeExecute scopeExecute;
+
+  while (instance) {
+    instance->StartNodeInstance();
+    instance.reset();
+    instance = InstancePool::global().park();
+  }
+}
+
+JSInstanceImpl::Ptr InstancePool::park() {
+  std::unique_lock<std::mutex> lock{_mutex};
+  if (_stop || _size == 0) {
+    return JSInstanceImpl::Ptr{};
+  }
+
+  ++_parked;
+  _park_cv.wait_for(lock, parkTimeout, [this]() { return _stop || !_handoff.empty(); });
+  --_parked;
 
-struct JSAsyncInfo
-{
-  std::string script;
-  std::vector<JSCallbackInfo> callbacks;
   JSInstanceImpl::Ptr instance;
-  uv_async_t async_handle;
+  if (!_handoff.empty()) {
+    instance = std::move(_handoff.front());
+    _handoff.pop_front();
+  }
+  return instance;
+}
+
+void InstancePool::refill() {
+  std::unique_lock<std::mutex> lock{_mutex};
+  while (true) {
+    _refill_cv.wait(lock, [this]() { return _stop || _ready.size() + _starting < _size; });
+    if (_stop) {
+      break;
+    }
+
+    ++_starting;
+    lock.unlock();
+
+    JSInstance* newInstance{nullptr};
+    const result_t res = CreateInstance(&newInstance);
+    JSInstanceImpl::Ptr instance;
+    instance.adopt(static_cast<JSInstanceImpl*>(newInstance));
+
+    lock.lock();
+    --_starting;
+
+    if (res == JS_SUCCESS && instance && instance->isRun() && !_stop && _ready.size() < _size) {
+      _ready.push_back(std::move(instance));
+      continue;
+    }
 
-  static JSAsyncInfo* create();
-  void Dispose();
+    lock.unlock();
+    const bool isFailed = instance && !instance->isRun();
+    if (instance) {
+      StopInstance(instance.detach());
+    }
+    if (isFailed) {
+      // Do not spin on broken framework
+      std::this_thread::sleep_for(std::chrono::seconds{1});
+    }
+    lock.lock();
+  }
+}
+
+
+// Shared event loop threads, each drives several instance loops (M:N).
+// Worker polls backend fd of instance loops in own loop and runs ready
+// instance loop without blocking, isolate is locked only while it runs.
+// Backend fd of instance loop is not available on Windows (IOCP),
+// instances use dedicated threads there.
+
+class LoopWorkerPool {
+public:
+  LoopWorkerPool() = default;
+
+  LoopWorkerPool(const LoopWorkerPool&) = delete;
+  LoopWorkerPool& operator=(const LoopWorkerPool&) = delete;
+
+  static LoopWorkerPool& global();
+
+  void setThreads(std::size_t count);
+  bool launch(JSInstanceImpl::Ptr instance);
+  void shutdown();
+
+private:
+  class Worker;
+
+  std::mutex _mutex;
+  std::size_t _threads{0};
+  std::vector<std::unique_ptr<Worker>> _workers;
+  bool _stop{false};
 };
 
-JSAsyncInfo* JSAsyncInfo::create() {
-    return new JSAsyncInfo;
+
+class LoopWorkerPool::Worker {
+public:
+  Worker();
+  ~Worker();
+
+  Worker(const Worker&) = delete;
+  Worker& operator=(const Worker&) = delete;
+
+  void add(JSInstanceImpl::Ptr instance);
+  std::size_t load() const;
+
+  // Thread exits after all instances are stopped
+  void stop();
+  void join();
+
+private:
+  struct Slot {
+    Worker* worker;
+    JSInstanceImpl::Ptr instance;
+    uv_poll_t poll;
+    uv_timer_t timer;
+    int closing{0};
+  };
+
+  void run();
+  void start(JSInstanceImpl::Ptr instance);
+  void step(Slot* slot);
+  void finish(Slot* slot);
+  void exitIfDone();
+
+  static void onAsync(uv_async_t* handle);
+  static void onPoll(uv_poll_t* handle, int status, int events);
+  static void onTimer(uv_timer_t* handle);
+  static void onClose(uv_handle_t* handle);
+
+  uv_loop_t _loop;
+  uv_async_t _async;
+  bool _isAsyncClosed{false};
+
+  std::mutex _mutex;
+  std::deque<JSInstanceImpl::Ptr> _incoming;
+  bool _stop{false};
+
+  std::atomic<std::size_t> _load{0};
+  std::thread _thread;
+};
+
+
+LoopWorkerPool& LoopWorkerPool::global() {
+  static LoopWorkerPool loopWorkerPool{};
+  return loopWorkerPool;
 }
 
-void JSAsyncInfo::Dispose() {
-    delete this;
+void LoopWorkerPool::setThreads(std::size_t count) {
+#ifndef _WIN32
+  std::unique_lock<std::mutex> lock{_mutex};
+  if (_stop) {
+    return;
+  }
+  _threads = count;
+  // Running workers are kept until shutdown, their instances are not migrated
+  while (_workers.size() < _threads) {
+    _workers.push_back(std::make_unique<Worker>());
+  }
+#endif
 }
 
+bool LoopWorkerPool::launch(JSInstanceImpl::Ptr instance) {
+  std::unique_lock<std::mutex> lock{_mutex};
+  if (_stop || _threads == 0) {
+    return false;
+  }
 
-void compileAndRun(node::Environment& env, const std::string&, const std::vector<JSCallbackInfo>&);
+  // Least loaded of active workers
+  Worker* worker = nullptr;
+  for (std::size_t i = 0; i < _threads && i < _workers.size(); ++i) {
+    if (worker == nullptr || _workers[i]->load() < worker->load()) {
+      worker = _workers[i].get();
+    }
+  }
+  if (worker == nullptr) {
+    return false;
+  }
+
+  worker->add(std::move(instance));
+  return true;
+}
+
+void LoopWorkerPool::shutdown() {
+  std::vector<std::unique_ptr<Worker>> workers;
+  {
+    std::unique_lock<std::mutex> lock{_mutex};
+    _stop = true;
+    _threads = 0;
+    workers.swap(_workers);
+  }
+
+  for (auto& worker : workers) {
+    worker->stop();
+  }
+  for (auto& worker : workers) {
+    worker->join();
+  }
+}
+
+
+LoopWorkerPool::Worker::Worker() {
+  CHECK_EQ(::uv_loop_init(&_loop), 0);
+  CHECK_EQ(::uv_async_init(&_loop, &_async, onAsync), 0);
+  _async.data = this;
+
+  _thread = std::thread([this]() { run(); });
+}
+
+LoopWorkerPool::Worker::~Worker() {
+  join();
+}
+
+void LoopWorkerPool::Worker::add(JSInstanceImpl::Ptr instance) {
+  ++_load;
+  {
+    std::unique_lock<std::mutex> lock{_mutex};
+    _incoming.push_back(std::move(instance));
+  }
+  CHECK_EQ(::uv_async_send(&_async), 0);
+}
+
+std::size_t LoopWorkerPool::Worker::load() const {
+  return _load;
+}
+
+void LoopWorkerPool::Worker::stop() {
+  {
+    std::unique_lock<std::mutex> lock{_mutex};
+    _stop = true;
+  }
+  CHECK_EQ(::uv_async_send(&_async), 0);
+}
+
+void LoopWorkerPool::Worker::join() {
+  if (_thread.joinable()) {
+    _thread.join();
+  }
+}
+
+void LoopWorkerPool::Worker::run() {
+  ExecutorCounter::ScopeExecute scopeExecute;
+
+  ::uv_run(&_loop, UV_RUN_DEFAULT);
+  CHECK_EQ(::uv_loop_close(&_loop), 0);
+}
+
+void LoopWorkerPool::Worker::start(JSInstanceImpl::Ptr instance) {
+  if (!instance->setupNodeInstance()) {
+    instance->teardownNodeInstance();
+    instance->setState(JSInstanceImpl::STOP);
+    --_load;
+    return;
+  }
+
+  Slot* slot = new Slot{};
+  slot->worker = this;
+  slot->instance = std::move(instance);
+
+  CHECK_EQ(::uv_poll_init(&_loop, &slot->poll, ::uv_backend_fd(slot->instance->event_loop())), 0);
+  slot->poll.data = slot;
+  CHECK_EQ(::uv_timer_init(&_loop, &slot->timer), 0);
+  slot->timer.data = slot;
+
+  CHECK_EQ(::uv_poll_start(&slot->poll, UV_READABLE, onPoll), 0);
+
+  step(slot);
+}
+
+void LoopWorkerPool::Worker::step(Slot* slot) {
+  JSInstanceImpl* instance = slot->instance.get();
+  if (!instance->runNodeInstance(UV_RUN_NOWAIT)) {
+    finish(slot);
+    return;
+  }
+
+  // Wake up for next timer of instance loop, 0 - pending callbacks or idle handles
+  const int timeout = ::uv_backend_timeout(instance->event_loop());
+  if (timeout < 0) {
+    ::uv_timer_stop(&slot->timer);
+  }
+  else {
+    ::uv_timer_start(&slot->timer, onTimer, static_cast<uint64_t>(timeout), 0);
+  }
+}
+
+void LoopWorkerPool::Worker::finish(Slot* slot) {
+  // Close poll before backend fd is closed with instance loop
+  slot->closing = 2;
+  ::uv_close(reinterpret_cast<uv_handle_t*>(&slot->poll), onClose);
+  ::uv_close(reinterpret_cast<uv_handle_t*>(&slot->timer), onClose);
+
+  JSInstanceImpl::Ptr instance = std::move(slot->instance);
+  instance->teardownNodeInstance();
+  instance->setState(JSInstanceImpl::STOP);
+  instance.reset();
+
+  --_load;
+  exitIfDone();
+}
+
+void LoopWorkerPool::Worker::exitIfDone() {
+  std::unique_lock<std::mutex> lock{_mutex};
+  if (_stop && _load == 0 && _incoming.empty() && !_isAsyncClosed) {
+    _isAsyncClosed = true;
+    ::uv_close(reinterpret_cast<uv_handle_t*>(&_async), nullptr);
+  }
+}
+
+void LoopWorkerPool::Worker::onAsync(uv_async_t* handle) {
+  Worker* worker = static_cast<Worker*>(handle->data);
+  CHECK_NOT_NULL(worker);
+
+  std::deque<JSInstanceImpl::Ptr> incoming;
+  {
+    std::unique_lock<std::mutex> lock{worker->_mutex};
+    incoming.swap(worker->_incoming);
+  }
+
+  for (JSInstanceImpl::Ptr& instance : incoming) {
+    worker->start(std::move(instance));
+  }
+
+  worker->exitIfDone();
+}
+
+void LoopWorkerPool::Worker::onPoll(uv_poll_t* handle, int, int) {
+  Slot* slot = static_cast<Slot*>(handle->data);
+  CHECK_NOT_NULL(slot);
+  if (slot->closing == 0) {
+    slot->worker->step(slot);
+  }
+}
+
+void LoopWorkerPool::Worker::onTimer(uv_timer_t* handle) {
+  Slot* slot = static_cast<Slot*>(handle->data);
+  CHECK_NOT_NULL(slot);
+  if (slot->closing == 0) {
+    slot->worker->step(slot);
+  }
+}
+
+void LoopWorkerPool::Worker::onClose(uv_handle_t* handle) {
+  Slot* slot = static_cast<Slot*>(handle->data);
+  CHECK_NOT_NULL(slot);
+  if (--(slot->closing) == 0) {
+    delete slot;
+  }
+}
+
+
+namespace {
+
+
+result_t stopInstances(const std::vector<JSInstanceImpl::Ptr>&, std::chrono::milliseconds, std::vector<StopResult>*);
+
+void uninitialize(std::optional<std::chrono::milliseconds> gracePeriod) {
+  if (!is_initilized.exchange(false)) {
+    return;
+  }
+
+  InstancePool::global().shutdown();
+  if (gracePeriod) {
+    stopInstances(RunningInstances::global().list(), *gracePeriod, nullptr);
+  }
+  LoopWorkerPool::global().shutdown();
+
+  ExecutorCounter::global().waitAllStop();
+
+  ConsoleDispatcher::global().shutdown();
+
+  TearDownOncePerProcess();
+}
+
+
+} // Anonymous namespace
+
+
+NODE_EXTERN void Uninitilize() {
+  uninitialize(std::nullopt);
+}
+
+NODE_EXTERN void Uninitilize(std::chrono::milliseconds gracePeriod) {
+  uninitialize(gracePeriod);
+}
+
+NODE_EXTERN result_t CreateInstance(JSInstance** outNewInstance) {
+  return CreateInstance(InstanceOptions{}, outNewInstance);
+}
+
+NODE_EXTERN result_t CreateInstance(const InstanceOptions& options, JSInstance** outNewInstance) {
+  JSInstanceImpl::Ptr instance = JSInstanceImpl::create(options);
+  if (!instance) return JS_ERROR;
+
+  if (!LoopWorkerPool::global().launch(instance)) {
+    InstancePool::global().launch(instance);
+  }
+
+  const auto timeout = std::chrono::seconds(30);
+  std::unique_lock<std::mutex> lock(instance->_state_mutex);
+  while (!instance->isInitialize()) {
+      if (instance->_state_cv.wait_for(lock, timeout) ==  std::cv_status::timeout) {
+          // setState() locks _state_mutex
+          lock.unlock();
+          instance->setState(JSInstanceImpl::TIMEOUT);
+          lock.lock();
+      }
+  }
+
+  *outNewInstance = instance.detach();
+
+  return JS_SUCCESS;
+}
+
+NODE_EXTERN result_t AcquireInstance(JSInstance** outNewInstance) {
+  JSInstanceImpl::Ptr instance = InstancePool::global().acquire();
+  if (!instance) {
+    return CreateInstance(outNewInstance);
+  }
+
+  *outNewInstance = instance.detach();
+
+  return JS_SUCCESS;
+}
+
+NODE_EXTERN void SetLoopThreads(std::size_t count) {
+  DCHECK(is_initilized);
+  LoopWorkerPool::global().setThreads(count);
+}
+
+NODE_EXTERN void SetInstancePoolSize(std::size_t size) {
+  DCHECK(is_initilized);
+  InstancePool::global().setSize(size);
+}
+
+NODE_EXTERN InstancePoolStats GetInstancePoolStats() {
+  return InstancePool::global().stats();
+}
+
+NODE_EXTERN result_t SetConsoleMessageCallback(JSInstance* instance_, ConsoleMessageCallback cb, const ConsoleOptions& options) {
+  if (instance_ == nullptr) {
+    return JS_ERROR;
+  }
+
+  JSInstanceImpl* instance = static_cast<JSInstanceImpl*>(instance_);
+  std::shared_ptr<ConsoleSink> sink;
+  if (cb) {
+    sink = std::make_shared<ConsoleSink>(instance->id(), std::move(cb), options);
+  }
+
+  // Sink is used only from instance thread
+  const bool isPosted = instance->postTask([instance, sink](Environment* env) {
+    if (env != nullptr) {
+      instance->setConsoleSink(sink);
+    }
+  });
+
+  return isPosted ? JS_SUCCESS : JS_ERROR;
+}
+
+NODE_EXTERN uint64_t GetInstanceId(JSInstance* instance) {
+  DCHECK_NOT_NULL(instance);
+  return static_cast<JSInstanceImpl*>(instance)->id();
+}
+
+NODE_EXTERN result_t GetInstanceStats(JSInstance* instance_, InstanceStats* stats) {
+  if (instance_ == nullptr || stats == nullptr) {
+    return JS_ERROR;
+  }
+
+  JSInstanceImpl* instance = static_cast<JSInstanceImpl*>(instance_);
+  *stats = InstanceStats{};
+  instance->_metrics.get(stats);
+
+  uv_threadpool_stats_t threadPoolStats;
+  if (::uv_threadpool_stats(instance->threadPool(), &threadPoolStats) == 0) {
+    stats->threadPoolThreads = threadPoolStats.nthreads;
+    stats->threadPoolQueueDepth = threadPoolStats.queued;
+  }
+
+  return JS_SUCCESS;
+}
+
+NODE_EXTERN result_t CreateThreadPool(std::size_t threads, JSThreadPool** outNewPool) {
+  if (outNewPool == nullptr) {
+    return JS_ERROR;
+  }
+
+  JSThreadPoolImpl::Ptr pool = JSThreadPoolImpl::create(threads);
+  if (!pool) {
+    return JS_ERROR;
+  }
+
+  // Reference of host, released by ReleaseThreadPool()
+  *outNewPool = pool.detach();
+  return JS_SUCCESS;
+}
+
+NODE_EXTERN result_t ReleaseThreadPool(JSThreadPool* pool_) {
+  if (pool_ == nullptr) {
+    return JS_ERROR;
+  }
+
+  JSThreadPoolImpl::Ptr pool;
+  pool.adopt(static_cast<JSThreadPoolImpl*>(pool_));
+  return JS_SUCCESS;
+}
+
+NODE_EXTERN result_t GetThreadPoolStats(JSThreadPool* pool, ThreadPoolStats* stats) {
+  if (stats == nullptr) {
+    return JS_ERROR;
+  }
+
+  uv_threadpool_t* threadPool = pool != nullptr ? static_cast<JSThreadPoolImpl*>(pool)->pool() : nullptr;
+  uv_threadpool_stats_t threadPoolStats;
+  if (::uv_threadpool_stats(threadPool, &threadPoolStats) != 0) {
+    return JS_ERROR;
+  }
+
+  stats->threads = threadPoolStats.nthreads;
+  stats->idleThreads = threadPoolStats.idle_threads;
+  stats->queueDepth = threadPoolStats.queued;
+  stats->submitted = threadPoolStats.submitted;
+  stats->completed = threadPoolStats.completed;
+  stats->stolen = threadPoolStats.stolen;
+  return JS_SUCCESS;
+}
+
+NODE_EXTERN result_t StartCpuProfile(JSInstance* instance_, std::chrono::microseconds samplingInterval) {
+  if (instance_ == nullptr) {
+    return JS_ERROR;
+  }
+
+  JSInstanceImpl* instance = static_cast<JSInstanceImpl*>(instance_);
+  if (!instance->isRun()) {
+    return JS_ERROR;
+  }
+
+  // Already started profile keeps running
+  auto task = [instance, samplingInterval](Environment* env) {
+    if (env != nullptr) {
+      instance->_profiler.start(env->isolate(), samplingInterval);
+    }
+  };
+
+  return instance->postTask(std::move(task)) ? JS_SUCCESS : JS_ERROR;
+}
+
+NODE_EXTERN std::future<std::string> StopCpuProfile(JSInstance* instance_) {
+  auto promise = std::make_shared<std::promise<std::string>>();
+  std::future<std::string> future = promise->get_future();
+
+  JSInstanceImpl* instance = static_cast<JSInstanceImpl*>(instance_);
+  auto task = [instance, promise](Environment* env) {
+    promise->set_value(env != nullptr ? instance->_profiler.stop(env->isolate()) : std::string{});
+  };
+
+  if (instance == nullptr || !instance->isRun() || !instance->postTask(std::move(task))) {
+    promise->set_value(std::string{});
+  }
+
+  return future;
+}
+
+NODE_EXTERN std::future<result_t> WriteHeapSnapshot(JSInstance* instance_, HeapSnapshotSink sink) {
+  auto promise = std::make_shared<std::promise<result_t>>();
+  std::future<result_t> future = promise->get_future();
+
+  JSInstanceImpl* instance = static_cast<JSInstanceImpl*>(instance_);
+  if (instance == nullptr || !sink || !instance->isRun()) {
+    promise->set_value(JS_ERROR);
+    return future;
+  }
+
+  auto task = [promise, sink = std::move(sink)](Environment* env) {
+    if (env == nullptr) {
+      promise->set_value(JS_ERROR);
+      return;
+    }
+    const bool isWritten = InstanceProfiler::writeHeapSnapshot(env->isolate(), sink);
+    promise->set_value(isWritten ? JS_SUCCESS : JS_ERROR);
+  };
+
+  if (!instance->postTask(std::move(task))) {
+    promise->set_value(JS_ERROR);
+  }
+
+  return future;
+}
+
+namespace {
+
+
+// Stop script is sent to all instances before waiting, instances are awaited with common deadline.
+// Instances not stopped by deadline (or failed) are terminated and awaited for one more grace period.
+result_t stopInstances(const std::vector<JSInstanceImpl::Ptr>& instances, std::chrono::milliseconds gracePeriod,
+                       std::vector<StopResult>* results) {
+  using clock = std::chrono::steady_clock;
+
+  const uint64_t startTime = ::uv_hrtime();
+  for (const JSInstanceImpl::Ptr& instance : instances) {
+    if (!instance->isStop()) {
+      instance->postStopScript();
+    }
+  }
+
+  const auto waitStop = [](JSInstanceImpl& instance, clock::time_point deadline, bool untilError) -> bool {
+    std::unique_lock<std::mutex> lock(instance._state_mutex);
+    instance._state_cv.wait_until(lock, deadline, [&instance, untilError]() {
+      return instance.isStop() || (untilError && instance.isError());
+    });
+    return instance.isStop();
+  };
+
+  std::vector<bool> terminated(instances.size(), false);
+  const clock::time_point graceDeadline = clock::now() + gracePeriod;
+  for (std::size_t i = 0; i < instances.size(); ++i) {
+    if (!waitStop(*instances[i], graceDeadline, true)) {
+      instances[i]->terminate();
+      terminated[i] = true;
+    }
+  }
+
+  result_t status = JS_SUCCESS;
+  const clock::time_point terminateDeadline = clock::now() + gracePeriod;
+  for (std::size_t i = 0; i < instances.size(); ++i) {
+    JSInstanceImpl& instance = *instances[i];
+    const bool isStopped = !terminated[i] || waitStop(instance, terminateDeadline, false);
+    if (!isStopped) {
+      status = JS_ERROR;
+    }
+
+    if (results != nullptr) {
+      StopResult result;
+      result.status = isStopped ? JS_SUCCESS : JS_ERROR;
+      result.terminated = terminated[i];
+      const uint64_t stopTime = isStopped ? instance.stopTime() : ::uv_hrtime();
+      if (stopTime > startTime) {
+        result.duration = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::nanoseconds{stopTime - startTime});
+      }
+      results->push_back(result);
+    }
+  }
+
+  return status;
+}
+
+
+} // Anonymous namespace
+
+
+NODE_EXTERN result_t StopInstances(const std::vector<JSInstance*>& instances_, std::chrono::milliseconds gracePeriod,
+                                      std::vector<StopResult>* results) {
+  result_t status = JS_SUCCESS;
+
+  std::vector<JSInstanceImpl::Ptr> instances;
+  std::vector<std::size_t> indexes;  // of instances in instances_
+  instances.reserve(instances_.size());
+  indexes.reserve(instances_.size());
+  for (std::size_t i = 0; i < instances_.size(); ++i) {
+    if (instances_[i] == nullptr) {
+      status = JS_ERROR;
+      continue;
+    }
+    JSInstanceImpl::Ptr instance;
+    instance.adopt(static_cast<JSInstanceImpl*>(instances_[i]));
+    instances.push_back(std::move(instance));
+    indexes.push_back(i);
+  }
+
+  std::vector<StopResult> stopResults;
+  if (stopInstances(instances, gracePeriod, results != nullptr ? &stopResults : nullptr) != JS_SUCCESS) {
+    status = JS_ERROR;
+  }
+
+  // Results match instances_ by index, null instance gets JS_ERROR
+  if (results != nullptr) {
+    results->assign(instances_.size(), StopResult{});
+    for (std::size_t i = 0; i < indexes.size(); ++i) {
+      (*results)[indexes[i]] = stopResults[i];
+    }
+  }
+
+  return status;
+}
+
+NODE_EXTERN result_t StopInstance(JSInstance* instance) {
+  if (instance == nullptr) {
+    return JS_ERROR;
+  }
+
+  return StopInstances({instance}, defaultStopGracePeriod);
+}
+
+
+namespace {
+
+
+void compileAndRun(node::Environment& env, const v8::Global<v8::Context>*, ScriptCache&, ScriptLimits&, CallbackRegistry&,
+                   const std::string&, const std::vector<JSCallbackInfo>&, ScriptResult*);
 
 
 } // Anonymous namespace
 
 
 void _async_execute_script(uv_async_t* handle) {
-  JSAsyncInfo* asyncInfo = ContainerOf(&JSAsyncInfo::async_handle, handle);
-  CHECK_NOT_NULL(asyncInfo);
+  JSInstanceImpl* instance = static_cast<JSInstanceImpl*>(handle->data);
+  CHECK_NOT_NULL(instance);
+
+  instance->executeScripts();
+}
+
+void JSInstanceImpl::keepAlive() {
+  // Running instance waits scripts, without periodic wakeups
+  ::uv_ref(reinterpret_cast<uv_handle_t*>(&_script_async));
+}
+
+void JSInstanceImpl::initIdleTimer() {
+  if (_options.idleTimeout.count() <= 0) {
+    return;
+  }
+
+  CHECK_EQ(::uv_timer_init(event_loop(), &_idle_timer), 0);
+  _idle_timer.data = this;
+  ::uv_unref(reinterpret_cast<uv_handle_t*>(&_idle_timer));
+  _is_idle_timer = true;
+
+  touchIdleTimer();
+}
+
+void JSInstanceImpl::closeIdleTimer() {
+  if (!_is_idle_timer) {
+    return;
+  }
+  _is_idle_timer = false;
+
+  ::uv_close(reinterpret_cast<uv_handle_t*>(&_idle_timer), nullptr);
+}
+
+void JSInstanceImpl::touchIdleTimer() {
+  if (!_is_idle_timer) {
+    return;
+  }
+
+  if (_is_idle) {
+    _is_idle = false;
+    _isolate->MemoryPressureNotification(v8::MemoryPressureLevel::kNone);
+  }
+
+  ::uv_timer_start(&_idle_timer, onIdle, static_cast<uint64_t>(_options.idleTimeout.count()), 0);
+}
+
+void JSInstanceImpl::onIdle(uv_timer_t* handle) {
+  JSInstanceImpl* instance = static_cast<JSInstanceImpl*>(handle->data);
+  CHECK_NOT_NULL(instance);
+
+  instance->_is_idle = true;
+
+  // Let V8 finish pending incremental work, then full compacting GC
+  // and release of unused pages
+  v8::Isolate* isolate = instance->_isolate;
+  const double deadline = per_process::v8_platform.Platform()->MonotonicallyIncreasingTime() + 0.1;
+  isolate->IdleNotificationDeadline(deadline);
+  isolate->MemoryPressureNotification(v8::MemoryPressureLevel::kCritical);
+
+  instance->_metrics.sampleHeap(isolate);
+}
+
+void JSInstanceImpl::initScriptQueue() {
+  const int resInit = ::uv_async_init(event_loop(), &_script_async, _async_execute_script);
+  CHECK_EQ(resInit, 0);
+  _script_async.data = this;
+
+  // Queued scripts do not keep event loop alive
+  ::uv_unref(reinterpret_cast<uv_handle_t*>(&_script_async));
+
+  _script_queue_closed = false;
+}
+
+void JSInstanceImpl::closeScriptQueue() {
+  if (_script_queue_closed.exchange(true)) {
+    return;
+  }
+
+  // Wait producers, which saw queue opened, before close async handle
+  while (_script_senders != 0) {
+    std::this_thread::yield();
+  }
+
+  ::uv_close(reinterpret_cast<uv_handle_t*>(&_script_async), nullptr);
+
+  for (auto& queue : _script_queues) {
+    while (JSScriptJob* job = queue.pop()) {
+      _metrics.scriptDequeued(job->priority, job->queuedTime, ::uv_hrtime());
+      job->cancel();
+      delete job;
+    }
+  }
+  for (auto& job : _drain_jobs) {
+    _metrics.scriptDequeued(job->priority, job->queuedTime, ::uv_hrtime());
+    job->cancel();
+  }
+  _drain_jobs.clear();
+}
+
+bool JSInstanceImpl::postScript(std::unique_ptr<JSScriptJob> job) {
+  ++_script_senders;
+  if (_script_queue_closed) {
+    --_script_senders;
+    return false;
+  }
+
+  job->queuedTime = ::uv_hrtime();
+  const ScriptPriority priority = job->priority;
+  if (job->drain) {
+    for (std::size_t lane = 0; lane < scriptPriorityCount; ++lane) {
+      job->drainCounts[lane] = _script_pushed[lane];
+    }
+  }
+  _metrics.scriptQueued(priority);
+  ++_script_pushed[static_cast<std::size_t>(priority)];
+  _script_queues[static_cast<std::size_t>(priority)].push(job.release());
+  const int resSend = ::uv_async_send(&_script_async);
+  CHECK_EQ(resSend, 0);
+
+  --_script_senders;
+  return true;
+}
+
+bool JSInstanceImpl::postTask(JSTask task) {
+  auto job = std::make_unique<JSScriptJob>();
+  job->task = std::move(task);
+  return postScript(std::move(job));
+}
+
+bool JSInstanceImpl::postStopScript() {
+  assert(!stopScript.empty());
+  if (!isRun()) {
+    return false;
+  }
 
-  JSInstanceImpl::Ptr instance = asyncInfo->instance;
-  CHECK(instance);
+  auto job = std::make_unique<JSScriptJob>();
+  job->script = stopScript;
+  job->priority = ScriptPriority::Background;
+  job->drain = true;
+  return postScript(std::move(job));
+}
 
+void JSInstanceImpl::bindCallbacks(v8::Local<v8::Context> context, const std::vector<JSCallbackInfo>& callbacks) {
+  for (const auto& cbInfo : callbacks) {
+    _callbacks.bind(context, cbInfo);
+  }
+}
 
-  node::Mutex::ScopedLock scopedLock{instance->_isolate_mutex};
+uint64_t JSInstanceImpl::newSubContextId() {
+  return ++_sub_context_last_id;
+}
 
+bool JSInstanceImpl::createSubContext(Environment* env, uint64_t id) {
+  v8::Isolate* isolate = env->isolate();
+  v8::HandleScope handleScope{isolate};
+
+  const std::string name = "jscript context " + std::to_string(id);
+  contextify::ContextOptions options;
+  options.name = v8::String::NewFromUtf8(isolate, name.c_str()).ToLocalChecked();
+  options.allow_code_gen_strings = v8::True(isolate);
+  options.allow_code_gen_wasm = v8::True(isolate);
+
+  // Same as vm.createContext(): ContextifyContext is deleted by environment cleanup
+  // or when context is garbage collected after SubContext releases it
+  v8::Local<v8::Object> sandbox = v8::Object::New(isolate);
+  auto* contextifyContext = new contextify::ContextifyContext(env, sandbox, options);
+  if (contextifyContext->context().IsEmpty()) {
+    return false;
+  }
 
-  node::Environment* env = instance->_env;
+  v8::Local<v8::Context> context = contextifyContext->context();
+  v8::Context::Scope contextScope{context};
+
+  v8::Local<v8::Object> console = v8::Object::New(isolate);
+  for (const ConsoleMethod& method : _console_methods) {
+    v8::Local<v8::String> methodName = v8::String::NewFromUtf8(isolate, method.name.c_str()).ToLocalChecked();
+    v8::Local<v8::Function> function = v8::Function::New(context, consoleCallback, method.data.Get(isolate)).ToLocalChecked();
+    console->Set(context, methodName, function).Check();
+  }
+  v8::Local<v8::String> consoleName = v8::String::NewFromUtf8(isolate, "console").ToLocalChecked();
+  context->Global()->Set(context, consoleName, console).Check();
+
+  auto subContext = std::make_unique<SubContext>();
+  subContext->context.Reset(isolate, context);
+  subContext->sandbox.Reset(isolate, sandbox);
+  for (const auto& cbInfo : CallbackRegistry::globalCallbacks()) {
+    subContext->callbacks.bind(context, cbInfo);
+  }
+
+  _sub_contexts[id] = std::move(subContext);
+  return true;
+}
+
+void JSInstanceImpl::destroySubContext(uint64_t id) {
+  _sub_contexts.erase(id);
+}
+
+SubContext* JSInstanceImpl::subContext(uint64_t id) {
+  auto it = _sub_contexts.find(id);
+  return it != std::end(_sub_contexts) ? it->second.get() : nullptr;
+}
+
+void JSInstanceImpl::executeScripts() {
+  node::Mutex::ScopedLock scopedLock{_isolate_mutex};
+
+  node::Environment* env = _env;
   CHECK_NOT_NULL(env);
 
-  const std::string& text = asyncInfo->script;
-  const auto& callbacks = asyncInfo->callbacks;
+  touchIdleTimer();
+
+  // Weighted rounds over lanes, then yield to event loop (timers, I/O)
+  // and continue by next wakeup if lanes are not drained
+  const uint64_t batchEnd = ::uv_hrtime() + scriptBatchTime;
+  bool isPending = true;
+  while (isPending && ::uv_hrtime() < batchEnd) {
+    isPending = false;
+    for (std::size_t lane = 0; lane < scriptPriorityCount; ++lane) {
+      std::size_t count = 0;
+      while (count < scriptLaneWeights[lane]) {
+        JSScriptJob* job = _script_queues[lane].pop();
+        if (job == nullptr) {
+          break;
+        }
+        ++_script_taken[lane];
+        if (job->drain) {
+          _drain_jobs.emplace_back(job);
+        }
+        else {
+          executeScript(env, std::unique_ptr<JSScriptJob>{job});
+        }
+        ++count;
+      }
+      if (count == scriptLaneWeights[lane]) {
+        isPending = true;
+      }
+    }
+
+    // Drain job waits for jobs pushed before it, push in progress wakes loop again
+    for (auto it = std::begin(_drain_jobs); it != std::end(_drain_jobs);) {
+      const uint64_t* counts = (*it)->drainCounts;
+      const bool isDrained = std::equal(counts, counts + scriptPriorityCount, _script_taken,
+                                        [](uint64_t pushed, uint64_t taken) { return taken >= pushed; });
+      if (!isDrained) {
+        ++it;
+        continue;
+      }
+      std::unique_ptr<JSScriptJob> job = std::move(*it);
+      it = _drain_jobs.erase(it);
+      executeScript(env, std::move(job));
+    }
+  }
+  if (isPending && !_script_queue_closed) {
+    CHECK_EQ(::uv_async_send(&_script_async), 0);
+  }
+
+  _metrics.sampleHeap(env->isolate());
+}
+
+void JSInstanceImpl::executeScript(Environment* env, std::unique_ptr<JSScriptJob> job) {
+  const uint64_t startTime = ::uv_hrtime();
+  _metrics.scriptDequeued(job->priority, job->queuedTime, startTime);
+  if (!env->can_call_into_js()) {
+    job->cancel();
+    return;
+  }
 
-  compileAndRun(*env, text, callbacks);
+  if (job->task) {
+    v8::HandleScope handleScope{env->isolate()};
+    v8::Context::Scope contextScope{env->context()};
+    job->task(env);
+    return;
+  }
 
-  if (::uv_is_closing(reinterpret_cast<uv_handle_t*>(handle)) == 0) {
-    const auto cb = [](uv_handle_t* handle) {
-      JSAsyncInfo* asyncInfo = ContainerOf(&JSAsyncInfo::async_handle, reinterpret_cast<uv_async_t*>(handle));
-      if (asyncInfo != nullptr) {
-          asyncInfo->Dispose();
-      }
-    };
+  SubContext* subContext = nullptr;
+  if (job->contextId != 0) {
+    subContext = this->subContext(job->contextId);
+    if (subContext == nullptr) {
+      job->cancel("Context is not created");
+      return;
+    }
+  }
+  const v8::Global<v8::Context>* context = subContext ? &subContext->context : nullptr;
+  CallbackRegistry& registry = subContext ? subContext->callbacks : _callbacks;
 
-    ::uv_close(reinterpret_cast<uv_handle_t*>(handle), cb);
+  if (!job->completion) {
+    compileAndRun(*env, context, _script_cache, _script_limits, registry, job->script, job->callbacks, nullptr);
+    _metrics.scriptDone(job->queuedTime, ::uv_hrtime());
+    return;
   }
+
+  ScriptResult result;
+  result.queueTime = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::nanoseconds{startTime - job->queuedTime});
+  compileAndRun(*env, context, _script_cache, _script_limits, registry, job->script, job->callbacks, &result);
+  const uint64_t endTime = ::uv_hrtime();
+  result.runTime = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::nanoseconds{endTime - startTime});
+  _metrics.scriptDone(job->queuedTime, endTime);
+
+  job->completion(std::move(result));
 }
 
 
 namespace {
 
 
-void insertCallbacks(v8::Local<v8::Context>, const JSCallbackInfo&);
-void processTryCatch(node::Environment&, const v8::TryCatch&);
-
-void compileAndRun(node::Environment& env, const std::string& text, const std::vector<JSCallbackInfo>& callbacks) {
-  v8::Local<v8::Context> context = env.context();
-  CHECK(!context.IsEmpty());
+void processTryCatch(node::Environment&, v8::Local<v8::Context>, const v8::TryCatch&, ScriptResult*);
+std::string serializeValue(v8::Local<v8::Context>, v8::Local<v8::Value>);
 
-  v8::Isolate* isolate = context->GetIsolate();
+// Runs in targetContext, or in main context of environment when it is nullptr
+void compileAndRun(node::Environment& env, const v8::Global<v8::Context>* targetContext, ScriptCache& cache,
+                   ScriptLimits& limits, CallbackRegistry& registry,
+                   const std::string& text, const std::vector<JSCallbackInfo>& callbacks, ScriptResult* result) {
+  v8::Isolate* isolate = env.isolate();
   CHECK_NOT_NULL(isolate);
 
   v8::Isolate::Scope isolateScope(isolate);
   v8::HandleScope scope(isolate);
+
+  v8::Local<v8::Context> context = targetContext ? targetContext->Get(isolate) : env.context();
+  CHECK(!context.IsEmpty());
   v8::Context::Scope contextScope(context);
 
+  // Unchanged callbacks are not re-bound
   for (const auto& cbInfo : callbacks) {
-    insertCallbacks(context, cbInfo);
+    registry.bind(context, cbInfo);
   }
 
-  v8::Local<v8::String> source = v8::String::NewFromUtf8(isolate, text.c_str()).ToLocalChecked();
-
   v8::TryCatch tryCatch{isolate};
 #ifdef _DEBUG
   tryCatch.SetVerbose(true);
@@ -1064,45 +2682,116 @@ void compileAndRun(node::Environment& env, const std::string& text, const std::v
   tryCatch.SetVerbose(false);
 #endif
 
-  v8::MaybeLocal<v8::Script> compileResult = v8::Script::Compile(context, source);
+  const std::size_t key = ScriptCache::hash(text);
+
+  v8::Local<v8::UnboundScript> unboundScript;
+  const bool isCached = cache.get(isolate, key, text, &unboundScript);
+  // Code cache is created when script is run again, one-off scripts do not pay for it
+  const bool needCodeCache = isCached && cache.markCodeCached(key) && CodeCacheStore::global().enabled();
+
+  if (!isCached) {
+    v8::Local<v8::String> source = v8::String::NewFromUtf8(isolate, text.c_str(), v8::NewStringType::kNormal, text.length()).ToLocalChecked();
+
+    std::shared_ptr<const CodeCacheStore::Data> codeCache = CodeCacheStore::global().get(text);
+    v8::MaybeLocal<v8::UnboundScript> compileResult;
+    bool codeCached = false;
+    if (codeCache) {
+      auto* cachedData = new v8::ScriptCompiler::CachedData(codeCache->data(), codeCache->size(),
+                                                            v8::ScriptCompiler::CachedData::BufferNotOwned);
+      v8::ScriptCompiler::Source scriptSource{source, cachedData};
+      compileResult = v8::ScriptCompiler::CompileUnboundScript(isolate, &scriptSource, v8::ScriptCompiler::kConsumeCodeCache);
+      codeCached = !scriptSource.GetCachedData()->rejected;
+    }
+    else {
+      v8::ScriptCompiler::Source scriptSource{source};
+      compileResult = v8::ScriptCompiler::CompileUnboundScript(isolate, &scriptSource, v8::ScriptCompiler::kNoCompileOptions);
+    }
 
-  if (tryCatch.HasCaught()) {
-    processTryCatch(env, tryCatch);
+    if (tryCatch.HasCaught()) {
+      processTryCatch(env, context, tryCatch, result);
+      return;
+    }
+    if (!compileResult.ToLocal(&unboundScript)) {
+      return;
+    }
+
+    cache.put(isolate, key, text, unboundScript, codeCached, script_cache_limit);
+  }
+
+  v8::Local<v8::Script> script = unboundScript->BindToCurrentContext();
+
+  // Termination requested after previous script is done must not break this one
+  if (std::exchange(limits.heapLimitReached, false)) {
+    isolate->CancelTerminateExecution();
+  }
+  bool timedOut = false;
+  v8::MaybeLocal<v8::Value> runResult;
+  const bool wasRunning = std::exchange(limits.running, true);
+  if (limits.timeout != 0) {
+    Watchdog watchdog{isolate, limits.timeout, &timedOut};
+    runResult = script->Run(context);
+  }
+  else {
+    runResult = script->Run(context);
+  }
+  limits.running = wasRunning;
+  if (runResult.IsEmpty()) {
+    node::Debug(&env, node::DebugCategory::NONE, "Run script faild");
   }
-  else if (!compileResult.IsEmpty()) {
-    v8::Local<v8::Script> script = compileResult.ToLocalChecked();
 
-    v8::MaybeLocal<v8::Value> result = script->Run(context);
-    if (result.IsEmpty()) {
-      node::Debug(&env, node::DebugCategory::NONE, "Run script faild");
+  const bool heapLimitReached = std::exchange(limits.heapLimitReached, false);
+  if (timedOut || heapLimitReached) {
+    // Termination may be requested after script is done, do not break next script
+    isolate->CancelTerminateExecution();
+    if (result != nullptr) {
+      result->status = JS_ERROR;
+      result->exception = timedOut ? "Script execution timed out after " + std::to_string(limits.timeout) + "ms"
+                                   : "Script execution terminated, heap limit reached";
+    }
+    if (heapLimitReached) {
+      isolate->LowMemoryNotification();
     }
+    return;
+  }
 
-    if (tryCatch.HasCaught()) {
-      processTryCatch(env, tryCatch);
+  if (tryCatch.HasCaught()) {
+    processTryCatch(env, context, tryCatch, result);
+  }
+  else if (result != nullptr && !runResult.IsEmpty()) {
+    result->status = JS_SUCCESS;
+    result->value = serializeValue(context, runResult.ToLocalChecked());
+  }
+
+  // After run code cache contains also lazy functions compiled during execution
+  if (needCodeCache) {
+    std::unique_ptr<v8::ScriptCompiler::CachedData> cachedData{v8::ScriptCompiler::CreateCodeCache(unboundScript)};
+    if (cachedData) {
+      CodeCacheStore::global().put(text, *cachedData);
     }
   }
 }
 
-void insertCallbacks(v8::Local<v8::Context> context, const JSCallbackInfo& callbackInfo) {
-  v8::Isolate* isolate = context->GetIsolate();
+std::string serializeValue(v8::Local<v8::Context> context, v8::Local<v8::Value> value) {
+  if (value->IsUndefined()) {
+    return std::string{};
+  }
 
-  v8::Local<v8::String> name = v8::String::NewFromUtf8(isolate, callbackInfo.name.c_str(),
-                                                       v8::NewStringType::kInternalized, callbackInfo.name.length()).ToLocalChecked();
+  v8::Isolate* isolate = context->GetIsolate();
+  v8::TryCatch tryCatch{isolate};
 
-  v8::Local<v8::External> external;
-  if (callbackInfo.external) {
-    external = v8::External::New(isolate, callbackInfo.external);
+  v8::Local<v8::String> json;
+  if (!v8::JSON::Stringify(context, value).ToLocal(&json)) {
+    // Not serializable (cyclic structure, BigInt), use string conversion
+    if (!value->ToString(context).ToLocal(&json)) {
+      return std::string{};
+    }
   }
 
-  v8::Local<v8::Function> function = v8::Function::New(context, callbackInfo.function, external).ToLocalChecked();
-  function->SetName(name);
-
-  v8::Local<v8::Object> global = context->Global();
-  global->Set(context, name, function).Check();
+  v8::String::Utf8Value utf8{isolate, json};
+  return std::string{*utf8, static_cast<std::size_t>(utf8.length())};
 }
 
-void processTryCatch(node::Environment& env, const v8::TryCatch& tryCatch) {
-  v8::Local<v8::Context> context = env.context();
+void processTryCatch(node::Environment& env, v8::Local<v8::Context> context, const v8::TryCatch& tryCatch, ScriptResult* result) {
   DCHECK(!context.IsEmpty());
 
   v8::Isolate* isolate = context->GetIsolate();
@@ -1125,6 +2814,17 @@ void processTryCatch(node::Environment& env, const v8::TryCatch& tryCatch) {
     }
 #endif
 
+  if (result != nullptr) {
+    result->status = JS_ERROR;
+    result->exception = *message != nullptr ? std::string{*message, static_cast<std::size_t>(message.length())} : std::string{};
+
+    v8::Local<v8::Value> stackTrace;
+    if (tryCatch.StackTrace(context).ToLocal(&stackTrace) && stackTrace->IsString()) {
+      v8::String::Utf8Value messageStackTrace{isolate, stackTrace};
+      result->exception.assign(*messageStackTrace, messageStackTrace.length());
+    }
+  }
+
 }
 
 
@@ -1137,46 +2837,417 @@ NODE_EXTERN result_t RunScriptText(JSInstance* instance,
     return RunScriptText(instance, script, dummy);
 }
 
-NODE_EXTERN result_t RunScriptText(JSInstance* instance_,
+NODE_EXTERN result_t RunScriptText(JSInstance* instance,
                                       const std::string& script,
                                       const std::vector<JSCallbackInfo>& callbacks) {
+    return RunScriptText(instance, script, callbacks, nullptr);
+}
+
+namespace {
+
+
+result_t postScriptText(JSInstanceImpl* instance, uint64_t contextId, const std::string& script,
+                        const std::vector<JSCallbackInfo>& callbacks, ScriptCompletion completion, ScriptPriority priority) {
+  if (!instance->isRun()) {
+    return JS_ERROR;
+  }
+
+  if (script.empty()) {
+    return JS_ERROR;
+  }
+
+  auto job = std::make_unique<JSScriptJob>();
+  job->script = script;
+  job->completion = std::move(completion);
+  job->contextId = contextId;
+  job->priority = priority;
+
+  const auto pred = [](const JSCallbackInfo& cbInfo) -> bool {
+      return (!cbInfo.name.empty()) && (cbInfo.function != nullptr);
+  };
+  std::copy_if(std::cbegin(callbacks), std::cend(callbacks), std::back_inserter(job->callbacks), pred);
+
+  if (!instance->postScript(std::move(job))) {
+    return JS_ERROR;
+  }
+
+  return JS_SUCCESS;
+}
+
+template <typename Target>
+std::future<ScriptResult> runScriptTextAsync(Target* target, const std::string& script,
+                                             const std::vector<JSCallbackInfo>& callbacks, ScriptPriority priority) {
+  auto promise = std::make_shared<std::promise<ScriptResult>>();
+  std::future<ScriptResult> future = promise->get_future();
+
+  auto completion = [promise](ScriptResult result) {
+    promise->set_value(std::move(result));
+  };
+
+  if (RunScriptText(target, script, callbacks, std::move(completion), priority) != JS_SUCCESS) {
+    ScriptResult result;
+    result.status = JS_ERROR;
+    result.exception = "Script is not queued";
+    promise->set_value(std::move(result));
+  }
+
+  return future;
+}
+
+
+} // Anonymous namespace
+
+
+NODE_EXTERN result_t RunScriptText(JSInstance* instance,
+                                      const std::string& script,
+                                      const std::vector<JSCallbackInfo>& callbacks,
+                                      ScriptCompletion completion) {
+  return RunScriptText(instance, script, callbacks, std::move(completion), ScriptPriority::Normal);
+}
+
+NODE_EXTERN result_t RunScriptText(JSInstance* instance_,
+                                      const std::string& script,
+                                      const std::vector<JSCallbackInfo>& callbacks,
+                                      ScriptCompletion completion,
+                                      ScriptPriority priority) {
   if (instance_ == nullptr) {
     return JS_ERROR;
   }
 
   JSInstanceImpl* instance  = static_cast<JSInstanceImpl*>(instance_);
+  return postScriptText(instance, 0, script, callbacks, std::move(completion), priority);
+}
+
+NODE_EXTERN result_t RegisterCallbacks(JSInstance* instance_, const std::vector<JSCallbackInfo>& callbacks) {
+  if (instance_ == nullptr) {
+    return JS_ERROR;
+  }
+
+  JSInstanceImpl* instance = static_cast<JSInstanceImpl*>(instance_);
   if (!instance->isRun()) {
     return JS_ERROR;
   }
 
-  if (script.empty()) {
+  std::vector<JSCallbackInfo> validCallbacks;
+  const auto pred = [](const JSCallbackInfo& cbInfo) -> bool {
+      return (!cbInfo.name.empty()) && (cbInfo.function != nullptr);
+  };
+  std::copy_if(std::cbegin(callbacks), std::cend(callbacks), std::back_inserter(validCallbacks), pred);
+
+  auto task = [instance, validCallbacks = std::move(validCallbacks)](Environment* env) {
+    if (env != nullptr) {
+      instance->bindCallbacks(env->context(), validCallbacks);
+    }
+  };
+
+  return instance->postTask(std::move(task)) ? JS_SUCCESS : JS_ERROR;
+}
+
+NODE_EXTERN void RegisterGlobalCallbacks(const std::vector<JSCallbackInfo>& callbacks) {
+  std::vector<JSCallbackInfo> validCallbacks;
+  const auto pred = [](const JSCallbackInfo& cbInfo) -> bool {
+      return (!cbInfo.name.empty()) && (cbInfo.function != nullptr);
+  };
+  std::copy_if(std::cbegin(callbacks), std::cend(callbacks), std::back_inserter(validCallbacks), pred);
+
+  CallbackRegistry::registerGlobal(validCallbacks);
+}
+
+NODE_EXTERN std::future<ScriptResult> RunScriptTextAsync(JSInstance* instance,
+                                                            const std::string& script,
+                                                            const std::vector<JSCallbackInfo>& callbacks) {
+  return runScriptTextAsync(instance, script, callbacks, ScriptPriority::Normal);
+}
+
+NODE_EXTERN std::future<ScriptResult> RunScriptTextAsync(JSInstance* instance,
+                                                            const std::string& script,
+                                                            const std::vector<JSCallbackInfo>& callbacks,
+                                                            ScriptPriority priority) {
+  return runScriptTextAsync(instance, script, callbacks, priority);
+}
+
+
+class JSContextImpl : public JSContext {
+public:
+  JSContextImpl(JSInstanceImpl::Ptr instance, uint64_t id)
+    :
+      _instance{std::move(instance)},
+      _id{id}
+  {}
+
+  JSInstanceImpl* instance() { return _instance.get(); }
+  uint64_t id() const { return _id; }
+
+private:
+  JSInstanceImpl::Ptr _instance;
+  const uint64_t _id;
+};
+
+NODE_EXTERN result_t CreateContext(JSInstance* instance_, JSContext** outNewContext) {
+  if (instance_ == nullptr || outNewContext == nullptr) {
+    return JS_ERROR;
+  }
+
+  JSInstanceImpl* instance = static_cast<JSInstanceImpl*>(instance_);
+  if (!instance->isRun()) {
+    return JS_ERROR;
+  }
+
+  // Context is created by first queued job, scripts queued later run in it
+  const uint64_t id = instance->newSubContextId();
+  auto task = [instance, id](Environment* env) {
+    if (env != nullptr) {
+      instance->createSubContext(env, id);
+    }
+  };
+  if (!instance->postTask(std::move(task))) {
+    return JS_ERROR;
+  }
+
+  *outNewContext = new JSContextImpl{JSInstanceImpl::Ptr{instance}, id};
+
+  return JS_SUCCESS;
+}
+
+NODE_EXTERN result_t DestroyContext(JSContext* context_) {
+  if (context_ == nullptr) {
+    return JS_ERROR;
+  }
+
+  std::unique_ptr<JSContextImpl> context{static_cast<JSContextImpl*>(context_)};
+  JSInstanceImpl* instance = context->instance();
+  const uint64_t id = context->id();
+
+  // Stopped instance has already released its contexts
+  auto task = [instance, id](Environment* env) {
+    if (env != nullptr) {
+      instance->destroySubContext(id);
+    }
+  };
+  instance->postTask(std::move(task));
+
+  return JS_SUCCESS;
+}
+
+NODE_EXTERN result_t RunScriptText(JSContext* context_,
+                                      const std::string& script,
+                                      const std::vector<JSCallbackInfo>& callbacks,
+                                      ScriptCompletion completion,
+                                      ScriptPriority priority) {
+  if (context_ == nullptr) {
     return JS_ERROR;
   }
 
-  std::unique_ptr<JSAsyncInfo> info{JSAsyncInfo::create()};
+  JSContextImpl* context = static_cast<JSContextImpl*>(context_);
+  return postScriptText(context->instance(), context->id(), script, callbacks, std::move(completion), priority);
+}
+
+NODE_EXTERN std::future<ScriptResult> RunScriptTextAsync(JSContext* context,
+                                                            const std::string& script,
+                                                            const std::vector<JSCallbackInfo>& callbacks,
+                                                            ScriptPriority priority) {
+  return runScriptTextAsync(context, script, callbacks, priority);
+}
+
+NODE_EXTERN result_t RegisterCallbacks(JSContext* context_, const std::vector<JSCallbackInfo>& callbacks) {
+  if (context_ == nullptr) {
+    return JS_ERROR;
+  }
 
-  info->instance.reset(instance);
-  info->script = script;
+  JSContextImpl* context = static_cast<JSContextImpl*>(context_);
+  JSInstanceImpl* instance = context->instance();
+  if (!instance->isRun()) {
+    return JS_ERROR;
+  }
 
+  std::vector<JSCallbackInfo> validCallbacks;
   const auto pred = [](const JSCallbackInfo& cbInfo) -> bool {
       return (!cbInfo.name.empty()) && (cbInfo.function != nullptr);
   };
-  std::copy_if(std::cbegin(callbacks), std::cend(callbacks), std::back_inserter(info->callbacks), pred);
+  std::copy_if(std::cbegin(callbacks), std::cend(callbacks), std::back_inserter(validCallbacks), pred);
 
-  const int resInit = ::uv_async_init(instance->event_loop(),
-                                      &info->async_handle,
-                                      _async_execute_script);
-  CHECK_EQ(resInit, 0);
+  auto task = [instance, id = context->id(), validCallbacks = std::move(validCallbacks)](Environment* env) {
+    SubContext* subContext = env != nullptr ? instance->subContext(id) : nullptr;
+    if (subContext == nullptr) {
+      return;
+    }
+
+    v8::Local<v8::Context> context = subContext->context.Get(env->isolate());
+    v8::Context::Scope contextScope{context};
+    for (const auto& cbInfo : validCallbacks) {
+      subContext->callbacks.bind(context, cbInfo);
+    }
+  };
 
-  ::uv_unref(reinterpret_cast<uv_handle_t*>(&info->async_handle));
-  const int resSend = ::uv_async_send(&info->async_handle);
+  return instance->postTask(std::move(task)) ? JS_SUCCESS : JS_ERROR;
+}
 
-  CHECK_EQ(resSend, 0);
-  info.release();
+NODE_EXTERN result_t SetGlobalBuffer(JSInstance* instance_, const std::string& name,
+                                        void* data, std::size_t length, BufferRelease release) {
+  if (instance_ == nullptr || name.empty()) {
+    return JS_ERROR;
+  }
+
+  JSInstanceImpl* instance = static_cast<JSInstanceImpl*>(instance_);
+  if (!instance->isRun()) {
+    return JS_ERROR;
+  }
+
+  struct ReleaseHint {
+    BufferRelease release;
+    std::size_t length;
+  };
+
+  auto task = [name, data, length, release = std::move(release)](Environment* env) {
+    if (env == nullptr) {
+      if (release) {
+        release(data, length);
+      }
+      return;
+    }
+
+    v8::Isolate* isolate = env->isolate();
+    v8::Local<v8::Context> context = env->context();
+
+    const auto freeCallback = [](char* data, void* hint) {
+      std::unique_ptr<ReleaseHint> releaseHint{static_cast<ReleaseHint*>(hint)};
+      if (releaseHint->release) {
+        releaseHint->release(data, releaseHint->length);
+      }
+    };
+    auto hint = std::make_unique<ReleaseHint>(ReleaseHint{release, length});
+
+    v8::Local<v8::Object> buffer;
+    if (!Buffer::New(isolate, static_cast<char*>(data), length, freeCallback, hint.get()).ToLocal(&buffer)) {
+      if (release) {
+        release(data, length);
+      }
+      return;
+    }
+    hint.release();
+
+    v8::Local<v8::String> bufferName = v8::String::NewFromUtf8(isolate, name.c_str(),
+                                                               v8::NewStringType::kInternalized, name.length()).ToLocalChecked();
+    context->Global()->Set(context, bufferName, buffer).Check();
+  };
+
+  if (!instance->postTask(std::move(task))) {
+    return JS_ERROR;
+  }
+
+  return JS_SUCCESS;
+}
+
+namespace {
+
+
+// Creates MessagePort of instance from entangled port data. Data is released
+// when instance is stopped, sibling port receives close then.
+JSTask createChannelPort(std::unique_ptr<worker::MessagePortData> data, const std::string& name) {
+  auto holder = std::make_shared<std::unique_ptr<worker::MessagePortData>>(std::move(data));
+
+  return [holder, name](Environment* env) {
+    if (env == nullptr) {
+      holder->reset();
+      return;
+    }
+
+    v8::Isolate* isolate = env->isolate();
+    v8::Local<v8::Context> context = env->context();
+    v8::TryCatch tryCatch{isolate};
+
+    // Prototype of MessagePort (postMessage(), on('message')) is set up by internal/worker/io
+    v8::Local<v8::Value> ioName = v8::String::NewFromUtf8(isolate, "internal/worker/io").ToLocalChecked();
+    if (env->native_module_require()->Call(context, v8::Null(isolate), 1, &ioName).IsEmpty()) {
+      holder->reset();
+      return;
+    }
+
+    worker::MessagePort* port = worker::MessagePort::New(env, context, std::move(*holder));
+    if (port == nullptr) {
+      return;
+    }
+
+    v8::Local<v8::String> portName = v8::String::NewFromUtf8(isolate, name.c_str(),
+                                                             v8::NewStringType::kInternalized, name.length()).ToLocalChecked();
+    context->Global()->Set(context, portName, port->object()).Check();
+  };
+}
+
+
+} // Anonymous namespace
+
+
+NODE_EXTERN result_t CreateChannel(JSInstance* first_, const std::string& firstName,
+                                      JSInstance* second_, const std::string& secondName) {
+  if (first_ == nullptr || second_ == nullptr || firstName.empty() || secondName.empty()) {
+    return JS_ERROR;
+  }
+
+  JSInstanceImpl* first = static_cast<JSInstanceImpl*>(first_);
+  JSInstanceImpl* second = static_cast<JSInstanceImpl*>(second_);
+  if (!first->isRun() || !second->isRun()) {
+    return JS_ERROR;
+  }
+
+  // Same as MessageChannel: messages posted to one port are queued to sibling,
+  // ports are not owned by any instance until created on instance thread
+  auto firstData = std::make_unique<worker::MessagePortData>(nullptr);
+  auto secondData = std::make_unique<worker::MessagePortData>(nullptr);
+  worker::MessagePortData::Entangle(firstData.get(), secondData.get());
+
+  if (!first->postTask(createChannelPort(std::move(firstData), firstName))) {
+    return JS_ERROR;
+  }
+  if (!second->postTask(createChannelPort(std::move(secondData), secondName))) {
+    return JS_ERROR;
+  }
 
   return JS_SUCCESS;
 }
 
+NODE_EXTERN bool GetBufferView(v8::Local<v8::Value> value, BufferView* view) {
+  if (value.IsEmpty() || view == nullptr) {
+    return false;
+  }
+
+  if (value->IsArrayBufferView()) {
+    v8::Local<v8::ArrayBufferView> arrayBufferView = value.As<v8::ArrayBufferView>();
+    view->backingStore = arrayBufferView->Buffer()->GetBackingStore();
+    view->data = static_cast<char*>(view->backingStore->Data()) + arrayBufferView->ByteOffset();
+    view->length = arrayBufferView->ByteLength();
+    return true;
+  }
+
+  if (value->IsArrayBuffer()) {
+    view->backingStore = value.As<v8::ArrayBuffer>()->GetBackingStore();
+  }
+  else if (value->IsSharedArrayBuffer()) {
+    view->backingStore = value.As<v8::SharedArrayBuffer>()->GetBackingStore();
+  }
+  else {
+    return false;
+  }
+
+  view->data = view->backingStore->Data();
+  view->length = view->backingStore->ByteLength();
+  return true;
+}
+
+NODE_EXTERN result_t LoadStartupSnapshot(const std::string& blobFile) {
+  DCHECK(is_initilized);
+  return StartupSnapshot::global().load(blobFile) ? JS_SUCCESS : JS_ERROR;
+}
+
+NODE_EXTERN void SetScriptCacheLimits(std::size_t instanceEntries, std::size_t processEntries) {
+  script_cache_limit = instanceEntries;
+  CodeCacheStore::global().setLimit(processEntries);
+}
+
+NODE_EXTERN void SetModuleCacheLimit(std::size_t entries) {
+  CodeCacheStore::modules().setLimit(entries);
+}
+
 MultiIsolatePlatform* GetGlobalPlatform() {
     return per_process::v8_platform.Platform();
 }
@@ -13,10 +13,14 @@
 #endif
 
 
+#include <array>
 #include <string>
 #include <vector>
 #include <functional>
 #include <ostream>
+#include <future>
+#include <chrono>
+#include <memory>
 
 
 namespace node {
@@ -43,6 +47,8 @@ NODE_EXTERN void Initialize(const std::string& origin, const std::string& extern
 
 
 NODE_EXTERN void Uninitilize();
+// Instances not stopped by host are stopped as by StopInstances() with grace period
+NODE_EXTERN void Uninitilize(std::chrono::milliseconds gracePeriod);
 
 
 typedef enum {
@@ -52,20 +58,283 @@ typedef enum {
 
 class JSInstance { };
 
+// Load V8 startup snapshot with node bootstrap (written by node_mksnapshot --blob
+// of the same build). Call after Initialize() and before any CreateInstance().
+// New instances deserialize isolate and context from it instead of building them.
+// JS_ERROR if blob is of other node or V8 version, or damaged.
+NODE_EXTERN result_t LoadStartupSnapshot(const std::string& blobFile);
+
 NODE_EXTERN result_t CreateInstance(JSInstance** outNewInstance);
+
+// Pool of threads for fs, DNS, zlib and crypto work of instances (libuv thread pool).
+// By default all instances share process-wide pool of UV_THREADPOOL_SIZE threads,
+// instances bound to other pool do not wait for that work of other instances.
+class JSThreadPool { };
+
+NODE_EXTERN result_t CreateThreadPool(std::size_t threads, JSThreadPool** outNewPool);
+// Pool is deleted after all its instances are stopped
+NODE_EXTERN result_t ReleaseThreadPool(JSThreadPool* pool);
+
+struct ThreadPoolStats {
+    std::size_t threads = 0;
+    std::size_t idleThreads = 0;
+    std::size_t queueDepth = 0;  // work waiting for thread
+    uint64_t    submitted = 0;
+    uint64_t    completed = 0;
+    uint64_t    stolen = 0;      // taken by idle worker from queue of other worker
+};
+
+// nullptr - process-wide pool
+NODE_EXTERN result_t GetThreadPoolStats(JSThreadPool* pool, ThreadPoolStats* stats);
+
+// Per-instance resource limits, 0 means V8 default or no limit.
+// Script exceeding heap limit or timeout is terminated and fails,
+// instance keeps running. Heap limit reached by timer, I/O or promise
+// callback stops instance with error.
+struct InstanceOptions {
+    std::size_t               maxHeapSize = 0;      // bytes
+    std::size_t               initialHeapSize = 0;  // bytes, used with maxHeapSize
+    std::chrono::milliseconds scriptTimeout{0};     // execution deadline of each script
+    // Inactivity (no queued scripts) after which instance heap is compacted
+    // and unused memory is released, 0 - disabled
+    std::chrono::milliseconds idleTimeout{0};
+    // ArrayBuffer memory (Buffer, TypedArray backing stores) of instance, allocation
+    // over limit fails with RangeError (after garbage collection retry)
+    std::size_t               maxArrayBufferMemory = 0;  // bytes
+    // Freed backing stores from 1 KiB to 4 MiB kept for reuse, 0 - no pooling
+    std::size_t               arrayBufferPoolSize = 0;   // bytes
+    // Thread pool shared by group of instances, or own pool of threadPoolSize threads,
+    // by default process-wide pool
+    JSThreadPool*             threadPool = nullptr;
+    std::size_t               threadPoolSize = 0;
+};
+
+NODE_EXTERN result_t CreateInstance(const InstanceOptions& options, JSInstance** outNewInstance);
 NODE_EXTERN result_t StopInstance(JSInstance* instance);
 
+constexpr std::chrono::milliseconds defaultStopGracePeriod{30000};
+
+struct StopResult {
+    result_t                  status = JS_ERROR;   // JS_ERROR - not stopped after termination
+    bool                      terminated = false;  // not stopped by stop script in grace period
+    std::chrono::microseconds duration{0};
+};
+
+// Stop instances in parallel: stop script is sent to all instances at once,
+// it runs after scripts queued before it in all priority lanes,
+// instances not stopped in grace period are terminated (running script is
+// interrupted) and awaited for one more grace period.
+// All instances are released, also on JS_ERROR.
+// results[i] is result of instances[i].
+NODE_EXTERN result_t StopInstances(const std::vector<JSInstance*>& instances,
+                                      std::chrono::milliseconds gracePeriod = defaultStopGracePeriod,
+                                      std::vector<StopResult>* results = nullptr);
+
+
+// Run new instances on shared event loop threads, several instances per thread,
+// instead of thread per instance. 0 (default) - thread per instance.
+// Long running script of instance delays other instances of same thread.
+// Not supported on Windows, instances use own threads.
+NODE_EXTERN void SetLoopThreads(std::size_t count);
+
+// Pool of ready instances, refilled in background. Threads of stopped instances
+// are reused for new instances while pool is enabled. Size 0 disables pool.
+NODE_EXTERN void SetInstancePoolSize(std::size_t size);
+
+// Take ready instance from pool, or create new one when pool is empty.
+// Instance is released by StopInstance as usual.
+NODE_EXTERN result_t AcquireInstance(JSInstance** outNewInstance);
+
+struct InstancePoolStats {
+    std::size_t size = 0;
+    std::size_t ready = 0;
+    std::size_t starting = 0;
+    std::size_t parkedThreads = 0;
+    std::size_t hits = 0;
+    std::size_t misses = 0;
+    std::size_t recycledThreads = 0;
+};
+
+NODE_EXTERN InstancePoolStats GetInstancePoolStats();
+
 
 struct JSCallbackInfo {
     std::string          name;
     v8::FunctionCallback function = nullptr;
     void*                external = nullptr;
+    // Optional typed fast path (v8-fast-api-calls.h), used by optimized code
+    // with V8 flag --turbo-fast-api-calls
+    const v8::CFunction* fastFunction = nullptr;
 };
 
+// Bind host functions to global once, later scripts call them without passing callbacks.
+// Per instance: bound before next queued script. Per process: bound to every new instance.
+NODE_EXTERN result_t RegisterCallbacks(JSInstance* instance, const std::vector<JSCallbackInfo>& callbacks);
+NODE_EXTERN void RegisterGlobalCallbacks(const std::vector<JSCallbackInfo>& callbacks);
+
 NODE_EXTERN result_t RunScriptText(JSInstance* instance, const std::string& script);
 NODE_EXTERN result_t RunScriptText(JSInstance* instance, const std::string& script, const std::vector<JSCallbackInfo>& callbacks);
 
 
+// Scripts are queued to lane of their priority. Each scheduling round takes
+// up to 8 interactive, 4 normal and 1 background script, event loop runs
+// between batches of rounds. Order is kept within a lane only.
+// Native tasks (RegisterCallbacks, SetGlobalBuffer, ...) use interactive lane.
+enum class ScriptPriority {
+    Interactive = 0,
+    Normal,
+    Background
+};
+
+constexpr std::size_t scriptPriorityCount = 3;
+
+struct ScriptResult {
+    result_t                  status = JS_ERROR;
+    std::string               value;      // JSON of script completion value, empty for undefined
+    std::string               exception;  // Exception stack trace or message
+    std::chrono::microseconds queueTime{0};
+    std::chrono::microseconds runTime{0};
+};
+
+// Called from instance thread when script is done or dropped by stopped instance
+using ScriptCompletion = std::function<void(ScriptResult)>;
+
+NODE_EXTERN result_t RunScriptText(JSInstance* instance, const std::string& script, const std::vector<JSCallbackInfo>& callbacks,
+                                      ScriptCompletion completion);
+NODE_EXTERN std::future<ScriptResult> RunScriptTextAsync(JSInstance* instance, const std::string& script,
+                                                            const std::vector<JSCallbackInfo>& callbacks = {});
+
+// Same with priority, overloads above use ScriptPriority::Normal
+NODE_EXTERN result_t RunScriptText(JSInstance* instance, const std::string& script, const std::vector<JSCallbackInfo>& callbacks,
+                                      ScriptCompletion completion, ScriptPriority priority);
+NODE_EXTERN std::future<ScriptResult> RunScriptTextAsync(JSInstance* instance, const std::string& script,
+                                                            const std::vector<JSCallbackInfo>& callbacks, ScriptPriority priority);
+
+// Pass host memory into instance as global Buffer without copy.
+// release is called from instance thread when Buffer is garbage collected
+// or instance is stopped, host must keep memory valid until then.
+using BufferRelease = std::function<void(void* data, std::size_t length)>;
+
+NODE_EXTERN result_t SetGlobalBuffer(JSInstance* instance, const std::string& name,
+                                        void* data, std::size_t length, BufferRelease release);
+
+// Message channel between instances (as MessageChannel of worker_threads): entangled
+// MessagePort is set as global firstName in first instance and secondName in second one.
+// Messages are structured clones, ArrayBuffers in transfer list are moved without copy:
+//   port.on('message', (value) => {}); port.postMessage(value, [arrayBuffer]);
+// Port of stopped instance is closed, sibling port receives 'close'.
+NODE_EXTERN result_t CreateChannel(JSInstance* first, const std::string& firstName,
+                                      JSInstance* second, const std::string& secondName);
+
+// Contents of ArrayBuffer, SharedArrayBuffer or ArrayBufferView (Buffer, TypedArray, DataView)
+// without copy. backingStore keeps memory allocated by instance alive, also after instance is stopped.
+struct BufferView {
+    std::shared_ptr<v8::BackingStore> backingStore;
+    void*                             data = nullptr;
+    std::size_t                       length = 0;
+};
+
+NODE_EXTERN bool GetBufferView(v8::Local<v8::Value> value, BufferView* view);
+
+// Lightweight context inside instance (as vm.createContext()): own global object,
+// console and callbacks, shares isolate, heap, event loop and compiled scripts of instance.
+// Node globals (require, process, Buffer) are not available in context.
+// Scripts of contexts are queued with scripts of instance and run in order.
+class JSContext { };
+
+NODE_EXTERN result_t CreateContext(JSInstance* instance, JSContext** outNewContext);
+// Releases context, also after instance is stopped
+NODE_EXTERN result_t DestroyContext(JSContext* context);
+
+NODE_EXTERN result_t RunScriptText(JSContext* context, const std::string& script,
+                                      const std::vector<JSCallbackInfo>& callbacks = {},
+                                      ScriptCompletion completion = nullptr,
+                                      ScriptPriority priority = ScriptPriority::Normal);
+NODE_EXTERN std::future<ScriptResult> RunScriptTextAsync(JSContext* context, const std::string& script,
+                                                            const std::vector<JSCallbackInfo>& callbacks = {},
+                                                            ScriptPriority priority = ScriptPriority::Normal);
+NODE_EXTERN result_t RegisterCallbacks(JSContext* context, const std::vector<JSCallbackInfo>& callbacks);
+
+// Limits of compiled scripts caches: per instance (compiled scripts)
+// and per process (serialized V8 code cache, used by new instances). 0 disables cache.
+// Code cache of script is created when instance runs the script second time.
+NODE_EXTERN void SetScriptCacheLimits(std::size_t instanceEntries, std::size_t processEntries);
+
+// Limit of process-wide code cache of CommonJS and ES modules, shared by all instances
+// and keyed by module source. 0 disables cache.
+NODE_EXTERN void SetModuleCacheLimit(std::size_t entries);
+
+
+// Script queue lane, queue time is for period since previous GetInstanceStats() call
+struct LaneStats {
+    std::size_t               queueDepth = 0;
+    std::size_t               scriptsDequeued = 0;  // since instance start
+    std::size_t               queueTimeCount = 0;
+    std::chrono::microseconds queueTimeP50{0};
+    std::chrono::microseconds queueTimeP99{0};
+    std::chrono::microseconds queueTimeMax{0};
+};
+
+// Instance metrics, cheap to poll (no round trip to instance thread).
+// Utilization and latency percentiles are for period since previous GetInstanceStats() call.
+struct InstanceStats {
+    // Event loop
+    double                    loopUtilization = 0;  // 0..1
+    std::chrono::microseconds loopIdleTime{0};      // since instance start
+    std::chrono::microseconds loopActiveTime{0};    // since instance start
+    // Script queue
+    std::size_t               queueDepth = 0;       // queued, not yet executed
+    std::size_t               scriptsExecuted = 0;  // since instance start
+    // V8 heap, sampled after scripts and garbage collections
+    std::size_t               heapTotal = 0;
+    std::size_t               heapUsed = 0;
+    std::size_t               heapLimit = 0;
+    std::size_t               externalMemory = 0;
+    // Garbage collection pauses, since instance start
+    std::size_t               gcCount = 0;
+    std::chrono::microseconds gcPauseTotal{0};
+    std::chrono::microseconds gcPauseMax{0};
+    // ArrayBuffer allocator, pooled backing stores are accounted by size class
+    std::size_t               arrayBufferLive = 0;         // bytes
+    std::size_t               arrayBufferPeak = 0;         // bytes, since instance start
+    std::size_t               arrayBufferPooled = 0;       // bytes kept for reuse
+    std::size_t               arrayBufferAllocations = 0;  // since instance start
+    std::size_t               arrayBufferPoolHits = 0;     // since instance start
+    std::size_t               arrayBufferFailures = 0;     // over limit (V8 retries after GC), since instance start
+    double                    arrayBufferAllocationRate = 0;  // bytes per second
+    // Thread pool of instance, shared with other instances of the pool
+    std::size_t               threadPoolThreads = 0;
+    std::size_t               threadPoolQueueDepth = 0;
+    // Script latency (queue and run time)
+    std::size_t               latencyCount = 0;
+    std::chrono::microseconds latencyP50{0};
+    std::chrono::microseconds latencyP90{0};
+    std::chrono::microseconds latencyP99{0};
+    std::chrono::microseconds latencyMax{0};
+    // Indexed by ScriptPriority
+    std::array<LaneStats, scriptPriorityCount> lanes;
+};
+
+NODE_EXTERN result_t GetInstanceStats(JSInstance* instance, InstanceStats* stats);
+
+// On-demand diagnostics of running instance, done on instance thread between scripts
+// (long running script delays them). CPU profiler is attached to isolate only while
+// profile is started, so instance runs without profiling overhead otherwise.
+NODE_EXTERN result_t StartCpuProfile(JSInstance* instance,
+                                        std::chrono::microseconds samplingInterval = std::chrono::microseconds{1000});
+// Profile in .cpuprofile JSON format (Chrome DevTools, node --cpu-prof), empty if not started
+// or instance is not running
+NODE_EXTERN std::future<std::string> StopCpuProfile(JSInstance* instance);
+
+// Called from instance thread with chunks of heap snapshot, returns false to abort
+using HeapSnapshotSink = std::function<bool(const char* data, std::size_t size)>;
+
+// Heap snapshot in .heapsnapshot JSON format (Chrome DevTools). Snapshot is taken
+// in memory of instance, only its JSON is streamed to sink without building whole
+// string. Result is ready after last chunk, JS_ERROR if instance is not running.
+NODE_EXTERN std::future<result_t> WriteHeapSnapshot(JSInstance* instance, HeapSnapshotSink sink);
+
+
 enum class ConsoleType {
     Log,
     Warn,
@@ -78,6 +347,26 @@ using ConsoleCallback = std::function<void(const v8::FunctionCallbackInfo<v8::Va
 
 NODE_EXTERN void SetConsoleCallback(JSInstance* instance, ConsoleCallback cb);
 
+// Console output formatted as by util.format(), node formatting and writing is skipped
+struct ConsoleMessage {
+    ConsoleType type = ConsoleType::Default;
+    std::string text;  // UTF-8
+    uint64_t    instanceId = 0;
+};
+
+struct ConsoleOptions {
+    bool        batched = false;     // deliver from dispatcher thread instead of instance thread
+    std::size_t bufferSize = 4096;   // messages, overflowing messages are dropped
+};
+
+using ConsoleMessageCallback = std::function<void(const ConsoleMessage* messages, std::size_t count)>;
+
+// Empty callback restores node console
+NODE_EXTERN result_t SetConsoleMessageCallback(JSInstance* instance, ConsoleMessageCallback cb,
+                                                  const ConsoleOptions& options = {});
+
+NODE_EXTERN uint64_t GetInstanceId(JSInstance* instance);
+
 inline std::ostream& operator<< (std::ostream& os, const ConsoleType type) {
     os << "ConsoleType: ";
 
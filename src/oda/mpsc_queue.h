@@ -0,0 +1,107 @@
+/*
+ * ODANT jscript, MPSCQueue
+*/
+
+
+#pragma once
+
+
+#include <atomic>
+#include <type_traits>
+
+
+namespace node {
+namespace jscript {
+
+
+// Intrusive multi-producer single-consumer queue (D. Vyukov).
+// push() is wait-free and may be called from any thread,
+// pop() must be called only from the consumer thread.
+// pop() may return nullptr while a concurrent push() is in progress,
+// the producer must wake the consumer after push() in that case.
+
+struct MPSCNode {
+  std::atomic<MPSCNode*> _next{nullptr};
+};
+
+
+template <typename Node>
+class MPSCQueue {
+  static_assert(std::is_base_of<MPSCNode, Node>::value, "Node must be derived from MPSCNode");
+
+public:
+  MPSCQueue();
+
+  MPSCQueue(const MPSCQueue&) = delete;
+  MPSCQueue& operator=(const MPSCQueue&) = delete;
+
+  void push(Node* node);
+  Node* pop();
+
+private:
+  void pushNode(MPSCNode* node);
+
+  std::atomic<MPSCNode*> _head;
+  MPSCNode* _tail;
+  MPSCNode _stub;
+};
+
+
+template <typename Node>
+MPSCQueue<Node>::MPSCQueue()
+  :
+    _head{&_stub},
+    _tail{&_stub}
+{}
+
+template <typename Node>
+void MPSCQueue<Node>::push(Node* node) {
+  pushNode(node);
+}
+
+template <typename Node>
+void MPSCQueue<Node>::pushNode(MPSCNode* node) {
+  node->_next.store(nullptr, std::memory_order_relaxed);
+  MPSCNode* prev = _head.exchange(node, std::memory_order_acq_rel);
+  prev->_next.store(node, std::memory_order_release);
+}
+
+template <typename Node>
+Node* MPSCQueue<Node>::pop() {
+  MPSCNode* tail = _tail;
+  MPSCNode* next = tail->_next.load(std::memory_order_acquire);
+
+  if (tail == &_stub) {
+    if (next == nullptr) {
+      return nullptr;
+    }
+    _tail = next;
+    tail = next;
+    next = next->_next.load(std::memory_order_acquire);
+  }
+
+  if (next != nullptr) {
+    _tail = next;
+    return static_cast<Node*>(tail);
+  }
+
+  MPSCNode* head = _head.load(std::memory_order_acquire);
+  if (tail != head) {
+    // Producer is between exchange and link
+    return nullptr;
+  }
+
+  pushNode(&_stub);
+
+  next = tail->_next.load(std::memory_order_acquire);
+  if (next != nullptr) {
+    _tail = next;
+    return static_cast<Node*>(tail);
+  }
+
+  return nullptr;
+}
+
+
+} // namespace jscript
+} // namespace node
@@ -0,0 +1,269 @@
+/*
+ * ODANT jscript, ScriptCache and CodeCacheStore
+*/
+
+
+#pragma once
+
+
+#include "node_mutex.h"
+
+#include <v8.h>
+
+#include <atomic>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+
+namespace node {
+namespace jscript {
+
+
+// Per-instance cache of compiled scripts, least recently used entry is evicted.
+// Must be used (and cleared) only from instance thread while isolate is alive.
+
+class ScriptCache {
+public:
+  ScriptCache() = default;
+
+  ScriptCache(const ScriptCache&) = delete;
+  ScriptCache& operator=(const ScriptCache&) = delete;
+
+  static std::size_t hash(const std::string& text);
+
+  bool get(v8::Isolate* isolate, std::size_t key, const std::string& text, v8::Local<v8::UnboundScript>* out);
+  void put(v8::Isolate* isolate, std::size_t key, const std::string& text, v8::Local<v8::UnboundScript> script,
+           bool codeCached, std::size_t limit);
+  // Marks entry as having process-wide code cache, true if it was not marked
+  bool markCodeCached(std::size_t key);
+  void clear();
+
+private:
+  struct Entry {
+    std::size_t key;
+    std::string text;
+    v8::Global<v8::UnboundScript> script;
+    bool codeCached;
+  };
+
+  std::list<Entry> _entries;
+  std::unordered_map<std::size_t, std::list<Entry>::iterator> _index;
+};
+
+
+inline std::size_t ScriptCache::hash(const std::string& text) {
+  return std::hash<std::string>{}(text);
+}
+
+inline bool ScriptCache::get(v8::Isolate* isolate, std::size_t key, const std::string& text, v8::Local<v8::UnboundScript>* out) {
+  auto it = _index.find(key);
+  if (it == std::end(_index)) {
+    return false;
+  }
+
+  Entry& entry = *(it->second);
+  if (entry.text != text) {
+    return false;
+  }
+
+  _entries.splice(std::begin(_entries), _entries, it->second);
+  *out = entry.script.Get(isolate);
+  return true;
+}
+
+inline void ScriptCache::put(v8::Isolate* isolate, std::size_t key, const std::string& text, v8::Local<v8::UnboundScript> script,
+                              bool codeCached, std::size_t limit) {
+  if (limit == 0) {
+    return;
+  }
+
+  auto it = _index.find(key);
+  if (it != std::end(_index)) {
+    _entries.erase(it->second);
+    _index.erase(it);
+  }
+
+  while (_entries.size() >= limit) {
+    _index.erase(_entries.back().key);
+    _entries.pop_back();
+  }
+
+  _entries.push_front(Entry{key, text, v8::Global<v8::UnboundScript>{isolate, script}, codeCached});
+  _index[key] = std::begin(_entries);
+}
+
+inline bool ScriptCache::markCodeCached(std::size_t key) {
+  auto it = _index.find(key);
+  if (it == std::end(_index) || it->second->codeCached) {
+    return false;
+  }
+
+  it->second->codeCached = true;
+  return true;
+}
+
+inline void ScriptCache::clear() {
+  _index.clear();
+  _entries.clear();
+}
+
+
+// Process-wide store of serialized V8 code cache, shared by all instances.
+// V8 verifies only source length and flags of cached data, so entry keeps its
+// content and found entry is used only if content is equal. Rejected data is replaced.
+// global() - scripts of RunScriptText, modules() - CommonJS and ES modules
+// compiled by node loaders, consulted by node_contextify.cc and module_wrap.cc.
+
+class CodeCacheStore {
+public:
+  using Data = std::vector<uint8_t>;
+
+  explicit CodeCacheStore(std::size_t limit = 256);
+
+  CodeCacheStore(const CodeCacheStore&) = delete;
+  CodeCacheStore& operator=(const CodeCacheStore&) = delete;
+
+  static CodeCacheStore& global();
+  static CodeCacheStore& modules();
+
+  // Content of entries, same text compiled as function or as module has different code cache
+  static std::string functionContent(v8::Isolate* isolate, v8::Local<v8::String> code,
+                                     const std::vector<v8::Local<v8::String>>& params);
+  static std::string moduleContent(v8::Isolate* isolate, v8::Local<v8::String> source);
+
+  std::shared_ptr<const Data> get(const std::string& content);
+  void put(const std::string& content, const v8::ScriptCompiler::CachedData& cachedData);
+  void clear();
+
+  void setLimit(std::size_t limit);
+  // false - limit is 0
+  bool enabled();
+
+private:
+  struct Entry {
+    std::size_t key;
+    std::string content;
+    std::shared_ptr<const Data> data;
+  };
+
+  void evict(std::size_t limit);
+
+  std::size_t _limit;
+
+  std::list<Entry> _entries;
+  std::unordered_map<std::size_t, std::list<Entry>::iterator> _index;
+
+  node::Mutex _mutex;
+};
+
+
+inline CodeCacheStore::CodeCacheStore(std::size_t limit)
+  :
+    _limit{limit}
+{}
+
+inline CodeCacheStore& CodeCacheStore::global() {
+  static CodeCacheStore codeCacheStore{};
+  return codeCacheStore;
+}
+
+inline CodeCacheStore& CodeCacheStore::modules() {
+  static CodeCacheStore codeCacheStore{4096};
+  return codeCacheStore;
+}
+
+inline std::string CodeCacheStore::functionContent(v8::Isolate* isolate, v8::Local<v8::String> code,
+                                                   const std::vector<v8::Local<v8::String>>& params) {
+  std::string text{"function("};
+  for (const auto& param : params) {
+    v8::String::Utf8Value utf8{isolate, param};
+    text.append(*utf8, utf8.length()).append(1, ',');
+  }
+  text.append(")\n");
+
+  v8::String::Utf8Value utf8{isolate, code};
+  text.append(*utf8, utf8.length());
+  return text;
+}
+
+inline std::string CodeCacheStore::moduleContent(v8::Isolate* isolate, v8::Local<v8::String> source) {
+  std::string text{"module\n"};
+  v8::String::Utf8Value utf8{isolate, source};
+  text.append(*utf8, utf8.length());
+  return text;
+}
+
+inline std::shared_ptr<const CodeCacheStore::Data> CodeCacheStore::get(const std::string& content) {
+  const std::size_t key = std::hash<std::string>{}(content);
+
+  node::Mutex::ScopedLock lock{_mutex};
+
+  auto it = _index.find(key);
+  if (it == std::end(_index)) {
+    return nullptr;
+  }
+
+  Entry& entry = *(it->second);
+  if (entry.content != content) {
+    return nullptr;
+  }
+
+  _entries.splice(std::begin(_entries), _entries, it->second);
+  return entry.data;
+}
+
+inline void CodeCacheStore::put(const std::string& content, const v8::ScriptCompiler::CachedData& cachedData) {
+  const std::size_t key = std::hash<std::string>{}(content);
+  auto data = std::make_shared<const Data>(cachedData.data, cachedData.data + cachedData.length);
+
+  node::Mutex::ScopedLock lock{_mutex};
+
+  if (_limit == 0) {
+    return;
+  }
+
+  // Entry of other content with same hash is replaced
+  auto it = _index.find(key);
+  if (it != std::end(_index)) {
+    _entries.erase(it->second);
+    _index.erase(it);
+  }
+
+  evict(_limit - 1);
+
+  _entries.push_front(Entry{key, content, std::move(data)});
+  _index[key] = std::begin(_entries);
+}
+
+inline void CodeCacheStore::evict(std::size_t limit) {
+  while (_entries.size() > limit) {
+    _index.erase(_entries.back().key);
+    _entries.pop_back();
+  }
+}
+
+inline void CodeCacheStore::clear() {
+  node::Mutex::ScopedLock lock{_mutex};
+  _index.clear();
+  _entries.clear();
+}
+
+inline void CodeCacheStore::setLimit(std::size_t limit) {
+  node::Mutex::ScopedLock lock{_mutex};
+  _limit = limit;
+  evict(_limit);
+}
+
+inline bool CodeCacheStore::enabled() {
+  node::Mutex::ScopedLock lock{_mutex};
+  return _limit != 0;
+}
+
+
+} // namespace jscript
+} // namespace node
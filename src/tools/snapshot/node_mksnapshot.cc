@@ -1,4 +1,5 @@
 #include <cstdio>
+#include <cstring>
 #include <fstream>
 #include <iostream>
 #include <sstream>
@@ -21,15 +22,23 @@ int main(int argc, char* argv[]) {
 
   v8::V8::SetFlagsFromString("--random_seed=42");
 
+  // --blob writes binary snapshot blob file instead of C++ source
+#ifdef _WIN32
+  const bool is_blob = argc > 2 && wcscmp(argv[1], L"--blob") == 0;
+#else
+  const bool is_blob = argc > 2 && strcmp(argv[1], "--blob") == 0;
+#endif
+  const int output_index = is_blob ? 2 : 1;
+
   if (argc < 2) {
-    std::cerr << "Usage: " << argv[0] << " <path/to/output.cc>\n";
+    std::cerr << "Usage: " << argv[0] << " [--blob] <path/to/output.cc>\n";
     return 1;
   }
 
   std::ofstream out;
-  out.open(argv[1], std::ios::out | std::ios::binary);
+  out.open(argv[output_index], std::ios::out | std::ios::binary);
   if (!out.is_open()) {
-    std::cerr << "Cannot open " << argv[1] << "\n";
+    std::cerr << "Cannot open " << argv[output_index] << "\n";
     return 1;
   }
 
@@ -44,7 +53,10 @@ int main(int argc, char* argv[]) {
 
   {
     std::string snapshot =
-        node::SnapshotBuilder::Generate(result.args, result.exec_args);
+        is_blob ? node::SnapshotBuilder::GenerateBlobFile(result.args,
+                                                          result.exec_args)
+                : node::SnapshotBuilder::Generate(result.args,
+                                                  result.exec_args);
     out << snapshot;
     out.close();
   }
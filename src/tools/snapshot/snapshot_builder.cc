@@ -60,9 +60,58 @@ const std::vector<size_t>* NodeMainInstance::GetIsolateDataIndexes() {
   return ss.str();
 }
 
-std::string SnapshotBuilder::Generate(
-    const std::vector<std::string> args,
-    const std::vector<std::string> exec_args) {
+// Blob file layout, in host byte order:
+//   char     magic[8]   "NODESNAP"
+//   uint32_t version_size
+//   char     version[version_size]  "<node version> <V8 version>"
+//   uint32_t blob_size
+//   char     blob[blob_size]
+//   uint64_t blob_checksum  FNV-1a of blob
+//   uint32_t indexes_count
+//   uint64_t indexes[indexes_count]
+// Blob is loaded only by the same node and V8 version, see
+// node::jscript::LoadStartupSnapshot().
+std::string FormatBlobFile(v8::StartupData* blob,
+                           const std::vector<size_t>& isolate_data_indexes) {
+  std::string result = "NODESNAP";
+
+  const std::string version =
+      std::string(NODE_VERSION) + " " + v8::V8::GetVersion();
+  const uint32_t version_size = static_cast<uint32_t>(version.size());
+  result.append(reinterpret_cast<const char*>(&version_size),
+                sizeof(version_size));
+  result.append(version);
+
+  const uint32_t blob_size = static_cast<uint32_t>(blob->raw_size);
+  result.append(reinterpret_cast<const char*>(&blob_size), sizeof(blob_size));
+  result.append(blob->data, blob->raw_size);
+
+  uint64_t blob_checksum = 14695981039346656037ull;
+  for (int i = 0; i < blob->raw_size; i++) {
+    blob_checksum ^= static_cast<unsigned char>(blob->data[i]);
+    blob_checksum *= 1099511628211ull;
+  }
+  result.append(reinterpret_cast<const char*>(&blob_checksum),
+                sizeof(blob_checksum));
+
+  const uint32_t indexes_count =
+      static_cast<uint32_t>(isolate_data_indexes.size());
+  result.append(reinterpret_cast<const char*>(&indexes_count),
+                sizeof(indexes_count));
+  for (size_t index : isolate_data_indexes) {
+    const uint64_t value = index;
+    result.append(reinterpret_cast<const char*>(&value), sizeof(value));
+  }
+
+  return result;
+}
+
+using FormatFunction = std::string (*)(v8::StartupData*,
+                                       const std::vector<size_t>&);
+
+std::string GenerateSnapshot(const std::vector<std::string> args,
+                             const std::vector<std::string> exec_args,
+                             FormatFunction format) {
   // TODO(joyeecheung): collect external references and set it in
   // params.external_references.
   std::vector<intptr_t> external_references = {
@@ -98,11 +147,23 @@ std::string SnapshotBuilder::Generate(
     // Must be done while the snapshot creator isolate is entered i.e. the
     // creator is still alive.
     main_instance->Dispose();
-    result = FormatBlob(&blob, isolate_data_indexes);
+    result = format(&blob, isolate_data_indexes);
     delete[] blob.data;
   }
 
   per_process::v8_platform.Platform()->UnregisterIsolate(isolate);
   return result;
 }
+
+std::string SnapshotBuilder::Generate(
+    const std::vector<std::string> args,
+    const std::vector<std::string> exec_args) {
+  return GenerateSnapshot(args, exec_args, FormatBlob);
+}
+
+std::string SnapshotBuilder::GenerateBlobFile(
+    const std::vector<std::string> args,
+    const std::vector<std::string> exec_args) {
+  return GenerateSnapshot(args, exec_args, FormatBlobFile);
+}
 }  // namespace node
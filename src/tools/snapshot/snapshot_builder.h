@@ -9,6 +9,9 @@ class SnapshotBuilder {
  public:
   static std::string Generate(const std::vector<std::string> args,
                               const std::vector<std::string> exec_args);
+  // Same snapshot as a binary blob file, loaded by embedders at runtime.
+  static std::string GenerateBlobFile(const std::vector<std::string> args,
+                                      const std::vector<std::string> exec_args);
 };
 }  // namespace node
 
@@ -0,0 +1,319 @@
+// Benchmark for jscript Conan package manager
+// Embedding layer: Initialize, instance lifecycle, script throughput and latency,
+// host callbacks and console redirection. Results are written as JSON to stdout
+// (or to file from first argument), progress goes to stderr.
+// Odant, 2021
+
+
+#include <jscript.h>
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <cstdlib>
+#include <string>
+#include <vector>
+#include <thread>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+#include <algorithm>
+#include <numeric>
+#include <filesystem>
+
+
+using clock_type = std::chrono::steady_clock;
+
+static const std::size_t lifecycle_iterations = 20;
+static const std::size_t scripts_per_level = 20000;
+static const std::size_t concurrency_levels[] = {1, 4, 16};
+static const std::size_t script_texts = 16;  // rotating texts, compiled once and cached
+static const std::size_t callback_calls = 1000000;
+static const std::size_t console_messages = 100000;
+
+
+static double to_us(clock_type::duration duration) {
+    return std::chrono::duration<double, std::micro>(duration).count();
+}
+
+// Latency distribution in microseconds
+static std::string distribution_json(std::vector<double> samples) {
+    std::ostringstream os;
+    if (samples.empty()) {
+        os << "{\"count\":0}";
+        return os.str();
+    }
+
+    std::sort(samples.begin(), samples.end());
+    const auto percentile = [&samples](double p) {
+        const std::size_t index = static_cast<std::size_t>(p * (samples.size() - 1) + 0.5);
+        return samples[index];
+    };
+    const double mean = std::accumulate(samples.begin(), samples.end(), 0.0) / samples.size();
+
+    os << "{\"count\":" << samples.size()
+       << ",\"mean_us\":" << mean
+       << ",\"p50_us\":" << percentile(0.5)
+       << ",\"p90_us\":" << percentile(0.9)
+       << ",\"p99_us\":" << percentile(0.99)
+       << ",\"max_us\":" << samples.back()
+       << "}";
+    return os.str();
+}
+
+static node::jscript::JSInstance* create_instance() {
+    node::jscript::JSInstance* instance{nullptr};
+    if (node::jscript::CreateInstance(&instance) != node::jscript::JS_SUCCESS || instance == nullptr) {
+        std::cerr << "Failed instance create" << std::endl;
+        std::exit(EXIT_FAILURE);
+    }
+    return instance;
+}
+
+static void stop_instance(node::jscript::JSInstance* instance) {
+    if (node::jscript::StopInstance(instance) != node::jscript::JS_SUCCESS) {
+        std::cerr << "Failed instance stop" << std::endl;
+        std::exit(EXIT_FAILURE);
+    }
+}
+
+static void run_script(node::jscript::JSInstance* instance, const std::string& script) {
+    const node::jscript::ScriptResult result = node::jscript::RunScriptTextAsync(instance, script).get();
+    if (result.status != node::jscript::JS_SUCCESS) {
+        std::cerr << "Failed running script: " << result.exception << std::endl;
+        std::exit(EXIT_FAILURE);
+    }
+}
+
+
+// CreateInstance and StopInstance latency
+
+static std::string bench_lifecycle() {
+    std::vector<double> create;
+    std::vector<double> stop;
+    for (std::size_t i = 0; i < lifecycle_iterations; ++i) {
+        const auto startTime = clock_type::now();
+        node::jscript::JSInstance* instance = create_instance();
+        const auto createdTime = clock_type::now();
+        stop_instance(instance);
+        const auto stoppedTime = clock_type::now();
+
+        create.push_back(to_us(createdTime - startTime));
+        stop.push_back(to_us(stoppedTime - createdTime));
+    }
+
+    return "{\"create\":" + distribution_json(std::move(create)) + ",\"stop\":" + distribution_json(std::move(stop)) + "}";
+}
+
+
+// RunScriptText throughput and end-to-end latency (submit to completion).
+// Rotating set of script texts measures queueing and dispatch, unique texts
+// add compilation of every script.
+
+static std::string bench_scripts(node::jscript::JSInstance* instance, std::size_t concurrency, bool isUnique) {
+    const std::size_t scripts_per_thread = scripts_per_level / concurrency;
+
+    std::mutex mtx;
+    std::condition_variable cv;
+    std::size_t done = 0;
+    std::atomic_bool failed{false};
+    std::vector<std::vector<double>> latencies(concurrency);
+
+    const auto startTime = clock_type::now();
+    std::vector<std::thread> threads;
+    for (std::size_t i = 0; i < concurrency; ++i) {
+        latencies[i].resize(scripts_per_thread);
+        threads.emplace_back([&, i]() {
+            for (std::size_t j = 0; j < scripts_per_thread; ++j) {
+                const auto submitTime = clock_type::now();
+                double* latency = &latencies[i][j];
+                auto completion = [&, submitTime, latency](node::jscript::ScriptResult result) {
+                    *latency = to_us(clock_type::now() - submitTime);
+                    if (result.status != node::jscript::JS_SUCCESS) {
+                        failed = true;
+                    }
+                    std::unique_lock<std::mutex> lock{mtx};
+                    ++done;
+                    cv.notify_all();
+                };
+                const std::string script = isUnique ? "var x" + std::to_string(i) + " = " + std::to_string(j) + ";"
+                                                    : "var x" + std::to_string(j % script_texts) + " = 0;";
+                if (node::jscript::RunScriptText(instance, script, {}, std::move(completion)) != node::jscript::JS_SUCCESS) {
+                    failed = true;
+                    std::unique_lock<std::mutex> lock{mtx};
+                    ++done;
+                }
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    const std::size_t total = scripts_per_thread * concurrency;
+    std::unique_lock<std::mutex> lock{mtx};
+    cv.wait(lock, [&done, total] { return done == total; });
+    lock.unlock();
+    const auto endTime = clock_type::now();
+
+    if (failed) {
+        std::cerr << "Failed running script" << std::endl;
+        std::exit(EXIT_FAILURE);
+    }
+
+    std::vector<double> samples;
+    for (auto& threadLatencies : latencies) {
+        samples.insert(samples.end(), threadLatencies.begin(), threadLatencies.end());
+    }
+
+    std::ostringstream os;
+    os << "{\"concurrency\":" << concurrency
+       << ",\"unique_texts\":" << (isUnique ? "true" : "false")
+       << ",\"scripts\":" << total
+       << ",\"scripts_per_sec\":" << total / std::chrono::duration<double>(endTime - startTime).count()
+       << ",\"latency\":" << distribution_json(std::move(samples))
+       << "}";
+    return os.str();
+}
+
+
+// Host callback call overhead, loop with callback minus empty loop
+
+static void noop_cb(const v8::FunctionCallbackInfo<v8::Value>&) {}
+
+static std::string bench_callbacks(node::jscript::JSInstance* instance) {
+    node::jscript::JSCallbackInfo callbackInfo;
+    callbackInfo.name = "benchNoop";
+    callbackInfo.function = noop_cb;
+    node::jscript::RegisterCallbacks(instance, {callbackInfo});
+
+    const std::string count = std::to_string(callback_calls);
+    run_script(instance, "function benchLoop(n) { for (let i = 0; i < n; ++i) {} }\n"
+                         "function benchCalls(n) { for (let i = 0; i < n; ++i) { benchNoop(i); } }\n"
+                         "benchLoop(1000); benchCalls(1000);");
+
+    auto startTime = clock_type::now();
+    run_script(instance, "benchLoop(" + count + ");");
+    const double loopTime = to_us(clock_type::now() - startTime);
+
+    startTime = clock_type::now();
+    run_script(instance, "benchCalls(" + count + ");");
+    const double callsTime = to_us(clock_type::now() - startTime);
+
+    std::ostringstream os;
+    os << "{\"calls\":" << callback_calls
+       << ",\"ns_per_call\":" << std::max(0.0, callsTime - loopTime) * 1000.0 / callback_calls
+       << "}";
+    return os.str();
+}
+
+
+// Console redirection throughput, from console.log() to delivery to host
+
+static std::string bench_console(bool batched) {
+    node::jscript::JSInstance* instance = create_instance();
+
+    std::mutex mtx;
+    std::condition_variable cv;
+    std::size_t received = 0;
+    auto callback = [&mtx, &cv, &received](const node::jscript::ConsoleMessage*, std::size_t count) {
+        std::unique_lock<std::mutex> lock{mtx};
+        received += count;
+        cv.notify_all();
+    };
+
+    node::jscript::ConsoleOptions options;
+    options.batched = batched;
+    options.bufferSize = console_messages * 2;  // no dropped messages
+    node::jscript::SetConsoleMessageCallback(instance, callback, options);
+    run_script(instance, "function benchConsole(n) { for (let i = 0; i < n; ++i) { console.log('message %d', i); } }\n"
+                         "benchConsole(0);");
+
+    const auto startTime = clock_type::now();
+    run_script(instance, "benchConsole(" + std::to_string(console_messages) + ");");
+    std::unique_lock<std::mutex> lock{mtx};
+    cv.wait(lock, [&received] { return received >= console_messages; });
+    lock.unlock();
+    const auto endTime = clock_type::now();
+
+    stop_instance(instance);
+
+    std::ostringstream os;
+    os << "{\"batched\":" << (batched ? "true" : "false")
+       << ",\"messages\":" << console_messages
+       << ",\"messages_per_sec\":" << console_messages / std::chrono::duration<double>(endTime - startTime).count()
+       << "}";
+    return os.str();
+}
+
+
+int main(int argc, char** argv) {
+
+    const std::string cwd = std::filesystem::current_path().string();
+
+    const std::string origin = "http://127.0.0.1:8080";
+    const std::string externalOrigin = "http://127.0.0.1:8080";
+    const std::string executeFile = argv[0];
+    const std::string coreFolder = cwd;
+    const std::string nodeFolder = coreFolder + "/node_modules";
+
+    std::ostringstream report;
+    report << "{";
+
+    const auto initStartTime = clock_type::now();
+    node::jscript::Initialize(origin, externalOrigin, executeFile, coreFolder, nodeFolder);
+    report << "\"initialize_us\":" << to_us(clock_type::now() - initStartTime);
+    std::cerr << "Initialize done" << std::endl;
+
+    report << ",\"lifecycle\":" << bench_lifecycle();
+    std::cerr << "Lifecycle done" << std::endl;
+
+    node::jscript::JSInstance* instance = create_instance();
+
+    report << ",\"scripts\":[";
+    bool isFirst = true;
+    for (const std::size_t concurrency : concurrency_levels) {
+        if (!isFirst) {
+            report << ",";
+        }
+        isFirst = false;
+        report << bench_scripts(instance, concurrency, false);
+        std::cerr << "Scripts with concurrency " << concurrency << " done" << std::endl;
+    }
+    report << "]";
+
+    report << ",\"scripts_compile\":[";
+    isFirst = true;
+    for (const std::size_t concurrency : concurrency_levels) {
+        if (!isFirst) {
+            report << ",";
+        }
+        isFirst = false;
+        report << bench_scripts(instance, concurrency, true);
+        std::cerr << "Scripts with unique texts and concurrency " << concurrency << " done" << std::endl;
+    }
+    report << "]";
+
+    report << ",\"callbacks\":" << bench_callbacks(instance);
+    std::cerr << "Callbacks done" << std::endl;
+
+    stop_instance(instance);
+
+    report << ",\"console\":[" << bench_console(false) << "," << bench_console(true) << "]";
+    std::cerr << "Console done" << std::endl;
+
+    report << "}";
+
+    node::jscript::Uninitilize();
+
+    if (argc > 1) {
+        std::ofstream file{argv[1]};
+        file << report.str() << std::endl;
+    }
+    else {
+        std::cout << report.str() << std::endl;
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,236 @@
+// Benchmark for jscript Conan package manager
+// libuv thread pool under fs, crypto, zlib and mixed work: group of instances on
+// shared pool of 4, 16 and 64 threads, throughput, latency of operation and pool
+// counters. Results are written as JSON to stdout (or to file from first argument),
+// progress goes to stderr. Runs of builds with different pools are compared by
+// their JSON results.
+// Odant, 2021
+
+
+#include <jscript.h>
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <cstdlib>
+#include <string>
+#include <vector>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+#include <algorithm>
+#include <filesystem>
+
+
+using clock_type = std::chrono::steady_clock;
+
+static const std::size_t pool_sizes[] = {4, 16, 64};
+static const char* const mixes[] = {"fs", "crypto", "zlib", "mixed"};
+static const std::size_t instances_per_pool = 4;
+static const std::size_t ops_per_instance = 2000;
+static const std::size_t inflight_per_instance = 64;
+
+
+// Operations are started up to inflight limit, benchDone(p50, p99) is called with
+// latencies of operations (microseconds) after all are finished
+static const char* const setup_script =
+    "const fs = require('fs');\n"
+    "const crypto = require('crypto');\n"
+    "const zlib = require('zlib');\n"
+    "const benchData = crypto.randomBytes(64 * 1024);\n"
+    "fs.writeFileSync('bench_thread_pool.dat', benchData);\n"
+    "const benchOps = {\n"
+    "  fs: (i, cb) => (i & 1) ? fs.stat('bench_thread_pool.dat', cb) : fs.readFile('bench_thread_pool.dat', cb),\n"
+    "  crypto: (i, cb) => (i & 1) ? crypto.randomBytes(4096, cb) : crypto.pbkdf2('secret', 'salt', 100, 32, 'sha256', cb),\n"
+    "  zlib: (i, cb) => zlib.deflate(benchData, cb),\n"
+    "  mixed: (i, cb) => [benchOps.fs, benchOps.crypto, benchOps.zlib][i % 3](i >> 2, cb)\n"
+    "};\n"
+    "function benchRun(mix, total, inflight) {\n"
+    "  const op = benchOps[mix];\n"
+    "  const latencies = [];\n"
+    "  let started = 0;\n"
+    "  const next = () => {\n"
+    "    if (started >= total) return;\n"
+    "    const startTime = process.hrtime.bigint();\n"
+    "    op(started++, (err) => {\n"
+    "      if (err) throw err;\n"
+    "      latencies.push(Number(process.hrtime.bigint() - startTime) / 1000);\n"
+    "      if (latencies.length === total) {\n"
+    "        latencies.sort((a, b) => a - b);\n"
+    "        benchDone(latencies[Math.floor(total * 0.5)], latencies[Math.floor(total * 0.99)]);\n"
+    "      } else {\n"
+    "        next();\n"
+    "      }\n"
+    "    });\n"
+    "  };\n"
+    "  for (let i = 0; i < inflight; ++i) next();\n"
+    "}\n";
+
+
+static std::mutex done_mutex;
+static std::condition_variable done_cv;
+static std::size_t done_count = 0;
+static std::vector<double> done_p50;
+static std::vector<double> done_p99;
+
+static void done_cb(const v8::FunctionCallbackInfo<v8::Value>& args) {
+    v8::Local<v8::Context> context = args.GetIsolate()->GetCurrentContext();
+    const double p50 = args[0]->NumberValue(context).FromMaybe(0);
+    const double p99 = args[1]->NumberValue(context).FromMaybe(0);
+
+    std::unique_lock<std::mutex> lock{done_mutex};
+    done_p50.push_back(p50);
+    done_p99.push_back(p99);
+    ++done_count;
+    done_cv.notify_all();
+}
+
+static void run_script(node::jscript::JSInstance* instance, const std::string& script) {
+    const node::jscript::ScriptResult result = node::jscript::RunScriptTextAsync(instance, script).get();
+    if (result.status != node::jscript::JS_SUCCESS) {
+        std::cerr << "Failed running script: " << result.exception << std::endl;
+        std::exit(EXIT_FAILURE);
+    }
+}
+
+static node::jscript::ThreadPoolStats pool_stats(node::jscript::JSThreadPool* pool) {
+    node::jscript::ThreadPoolStats stats;
+    if (node::jscript::GetThreadPoolStats(pool, &stats) != node::jscript::JS_SUCCESS) {
+        std::cerr << "Failed thread pool stats" << std::endl;
+        std::exit(EXIT_FAILURE);
+    }
+    return stats;
+}
+
+
+// One mix on all instances of pool at once, latency is worst of instances
+
+static std::string bench_mix(node::jscript::JSThreadPool* pool,
+                             const std::vector<node::jscript::JSInstance*>& instances,
+                             const std::string& mix) {
+    {
+        std::unique_lock<std::mutex> lock{done_mutex};
+        done_count = 0;
+        done_p50.clear();
+        done_p99.clear();
+    }
+
+    const node::jscript::ThreadPoolStats startStats = pool_stats(pool);
+    const std::string script = "benchRun('" + mix + "', " + std::to_string(ops_per_instance) + ", " +
+                               std::to_string(inflight_per_instance) + ");";
+
+    const auto startTime = clock_type::now();
+    for (auto instance : instances) {
+        if (node::jscript::RunScriptText(instance, script) != node::jscript::JS_SUCCESS) {
+            std::cerr << "Failed running script" << std::endl;
+            std::exit(EXIT_FAILURE);
+        }
+    }
+    std::unique_lock<std::mutex> lock{done_mutex};
+    done_cv.wait(lock, [&instances] { return done_count == instances.size(); });
+    const auto endTime = clock_type::now();
+    const double p50 = *std::max_element(done_p50.begin(), done_p50.end());
+    const double p99 = *std::max_element(done_p99.begin(), done_p99.end());
+    lock.unlock();
+
+    const node::jscript::ThreadPoolStats endStats = pool_stats(pool);
+    const std::size_t ops = ops_per_instance * instances.size();
+
+    std::ostringstream os;
+    os << "{\"mix\":\"" << mix << "\""
+       << ",\"ops\":" << ops
+       << ",\"ops_per_sec\":" << ops / std::chrono::duration<double>(endTime - startTime).count()
+       << ",\"p50_us\":" << p50
+       << ",\"p99_us\":" << p99
+       << ",\"submitted\":" << endStats.submitted - startStats.submitted
+       << ",\"stolen\":" << endStats.stolen - startStats.stolen
+       << "}";
+    return os.str();
+}
+
+static std::string bench_pool(std::size_t threads) {
+    node::jscript::JSThreadPool* pool{nullptr};
+    if (node::jscript::CreateThreadPool(threads, &pool) != node::jscript::JS_SUCCESS) {
+        std::cerr << "Failed thread pool create" << std::endl;
+        std::exit(EXIT_FAILURE);
+    }
+
+    node::jscript::InstanceOptions options;
+    options.threadPool = pool;
+
+    node::jscript::JSCallbackInfo callbackInfo;
+    callbackInfo.name = "benchDone";
+    callbackInfo.function = done_cb;
+
+    std::vector<node::jscript::JSInstance*> instances(instances_per_pool, nullptr);
+    for (auto& instance : instances) {
+        if (node::jscript::CreateInstance(options, &instance) != node::jscript::JS_SUCCESS || instance == nullptr) {
+            std::cerr << "Failed instance create" << std::endl;
+            std::exit(EXIT_FAILURE);
+        }
+        node::jscript::RegisterCallbacks(instance, {callbackInfo});
+        run_script(instance, setup_script);
+    }
+
+    std::ostringstream os;
+    os << "{\"threads\":" << threads << ",\"mixes\":[";
+    bool isFirst = true;
+    for (const char* mix : mixes) {
+        if (!isFirst) {
+            os << ",";
+        }
+        isFirst = false;
+        os << bench_mix(pool, instances, mix);
+        std::cerr << "Pool of " << threads << " threads, " << mix << " done" << std::endl;
+    }
+    os << "]}";
+
+    if (node::jscript::StopInstances(instances) != node::jscript::JS_SUCCESS) {
+        std::cerr << "Failed instances stop" << std::endl;
+        std::exit(EXIT_FAILURE);
+    }
+    node::jscript::ReleaseThreadPool(pool);
+    return os.str();
+}
+
+
+int main(int argc, char** argv) {
+
+    const std::string cwd = std::filesystem::current_path().string();
+
+    const std::string origin = "http://127.0.0.1:8080";
+    const std::string externalOrigin = "http://127.0.0.1:8080";
+    const std::string executeFile = argv[0];
+    const std::string coreFolder = cwd;
+    const std::string nodeFolder = coreFolder + "/node_modules";
+
+    node::jscript::Initialize(origin, externalOrigin, executeFile, coreFolder, nodeFolder);
+    std::cerr << "Initialize done" << std::endl;
+
+    std::ostringstream report;
+    report << "{\"instances\":" << instances_per_pool
+           << ",\"inflight_per_instance\":" << inflight_per_instance
+           << ",\"pools\":[";
+    bool isFirst = true;
+    for (const std::size_t threads : pool_sizes) {
+        if (!isFirst) {
+            report << ",";
+        }
+        isFirst = false;
+        report << bench_pool(threads);
+    }
+    report << "]}";
+
+    node::jscript::Uninitilize();
+    std::filesystem::remove("bench_thread_pool.dat");
+
+    if (argc > 1) {
+        std::ofstream file{argv[1]};
+        file << report.str() << std::endl;
+    }
+    else {
+        std::cout << report.str() << std::endl;
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -19,6 +19,7 @@ class PackageTestConan(ConanFile):
         self.copy("jscriptd", dst="bin", src="bin")
         self.copy("jscript.exe", dst="bin", src="bin")
         self.copy("jscriptd.exe", dst="bin", src="bin")
+        self.copy("jscript_snapshot.blob", dst="bin", src="bin")
 
     def build(self):
         cmake = CMake(self, generator="Ninja", msbuild_verbosity='normal')
@@ -0,0 +1,117 @@
+// Test for jscript Conan package manager
+// ArrayBuffer allocator of instance: limit, pooling and counters
+// Odant, 2021
+
+
+#ifdef NDEBUG
+#undef NDEBUG
+#endif
+
+#include <jscript.h>
+
+#include <iostream>
+#include <cstdlib>
+#include <string>
+#include <filesystem>
+#include <cassert>
+
+
+static void print_stats(const node::jscript::InstanceStats& stats) {
+    std::cout << "arrayBufferLive: " << stats.arrayBufferLive
+              << ", arrayBufferPeak: " << stats.arrayBufferPeak
+              << ", arrayBufferPooled: " << stats.arrayBufferPooled
+              << ", arrayBufferAllocations: " << stats.arrayBufferAllocations
+              << ", arrayBufferPoolHits: " << stats.arrayBufferPoolHits
+              << ", arrayBufferFailures: " << stats.arrayBufferFailures
+              << ", arrayBufferAllocationRate: " << stats.arrayBufferAllocationRate << " B/s"
+              << std::endl;
+}
+
+
+int main(int argc, char** argv) {
+
+    const std::string cwd = std::filesystem::current_path().string();
+    std::cout << "Current directory: " << cwd << std::endl;
+
+    const std::string origin = "http://127.0.0.1:8080";
+    const std::string externalOrigin = "http://127.0.0.1:8080";
+    const std::string executeFile = argv[0];
+    const std::string coreFolder = cwd;
+    const std::string nodeFolder = coreFolder + "/node_modules";
+
+    node::jscript::Initialize(origin, externalOrigin, executeFile, coreFolder, nodeFolder);
+    std::cout << "node::jscript::Initialize() done" << std::endl;
+
+    const std::size_t limit = 32 * 1024 * 1024;
+
+    node::jscript::InstanceOptions options;
+    options.maxArrayBufferMemory = limit;
+    options.arrayBufferPoolSize = 8 * 1024 * 1024;
+
+    node::jscript::result_t res;
+    node::jscript::JSInstance* instance{nullptr};
+    res = node::jscript::CreateInstance(options, &instance);
+    assert(res == node::jscript::JS_SUCCESS);
+    assert(instance != nullptr);
+    std::cout << "Instance created" << std::endl;
+
+    node::jscript::InstanceStats stats;
+    res = node::jscript::GetInstanceStats(instance, &stats);
+    assert(res == node::jscript::JS_SUCCESS);
+    print_stats(stats);
+
+    // Churn of backing stores (more than limit in total), freed ones are reused
+
+    node::jscript::ScriptResult result = node::jscript::RunScriptTextAsync(instance,
+        "let sum = 0;\n"
+        "for (let i = 0; i < 2000; ++i) {\n"
+        "  const buffer = Buffer.alloc(64 * 1024, i & 0xff);\n"
+        "  sum += buffer[buffer.length - 1];\n"
+        "}\n"
+        "sum;").get();
+    assert(result.status == node::jscript::JS_SUCCESS);
+
+    res = node::jscript::GetInstanceStats(instance, &stats);
+    assert(res == node::jscript::JS_SUCCESS);
+    print_stats(stats);
+    assert(stats.arrayBufferAllocations >= 2000);
+    assert(stats.arrayBufferPoolHits > 0);
+    assert(stats.arrayBufferPeak <= limit);
+    assert(stats.arrayBufferLive <= stats.arrayBufferPeak);
+    assert(stats.arrayBufferAllocationRate > 0);
+
+    // Reused block is zero filled
+
+    result = node::jscript::RunScriptTextAsync(instance,
+        "new Uint8Array(64 * 1024).every((x) => x === 0)").get();
+    assert(result.status == node::jscript::JS_SUCCESS);
+    assert(result.value == "true");
+
+    // Over limit
+
+    result = node::jscript::RunScriptTextAsync(instance,
+        "new ArrayBuffer(64 * 1024 * 1024)").get();
+    std::cout << "Exception: " << result.exception << std::endl;
+    assert(result.status == node::jscript::JS_ERROR);
+    assert(result.exception.find("RangeError") != std::string::npos);
+
+    res = node::jscript::GetInstanceStats(instance, &stats);
+    assert(res == node::jscript::JS_SUCCESS);
+    print_stats(stats);
+    assert(stats.arrayBufferFailures > 0);
+
+    // Instance keeps running
+
+    result = node::jscript::RunScriptTextAsync(instance, "Buffer.alloc(1024).length").get();
+    assert(result.status == node::jscript::JS_SUCCESS);
+    assert(result.value == "1024");
+
+    res = node::jscript::StopInstance(instance);
+    assert(res == node::jscript::JS_SUCCESS);
+    std::cout << "Instance stopped" << std::endl;
+
+    node::jscript::Uninitilize();
+    std::cout << "node::jscript::Uninitilize() done" << std::endl;
+
+    return EXIT_SUCCESS;
+}
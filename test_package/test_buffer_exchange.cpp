@@ -0,0 +1,118 @@
+// Test for jscript Conan package manager
+// SetGlobalBuffer and GetBufferView, data exchange without copy
+// Odant, 2021
+
+
+#ifdef NDEBUG
+#undef NDEBUG
+#endif
+
+#include <jscript.h>
+
+#include <iostream>
+#include <cstdlib>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <filesystem>
+#include <cassert>
+
+
+static std::vector<uint8_t> host_data(1024 * 1024);
+static std::atomic_bool is_released{false};
+
+static node::jscript::BufferView result_view;
+static bool is_result_done = false;
+static std::mutex result_mutex;
+static std::condition_variable result_cv;
+static void result_cb(const v8::FunctionCallbackInfo<v8::Value>& args) {
+    std::unique_lock<std::mutex> lock{result_mutex};
+    assert(args.Length() == 1);
+    const bool isView = node::jscript::GetBufferView(args[0], &result_view);
+    assert(isView);
+    is_result_done = true;
+    result_cv.notify_all();
+}
+
+
+int main(int argc, char** argv) {
+
+    const std::string cwd = std::filesystem::current_path().string();
+    std::cout << "Current directory: " << cwd << std::endl;
+
+    const std::string origin = "http://127.0.0.1:8080";
+    const std::string externalOrigin = "http://127.0.0.1:8080";
+    const std::string executeFile = argv[0];
+    const std::string coreFolder = cwd;
+    const std::string nodeFolder = coreFolder + "/node_modules";
+
+    node::jscript::Initialize(origin, externalOrigin, executeFile, coreFolder, nodeFolder);
+    std::cout << "node::jscript::Initialize() done" << std::endl;
+
+    node::jscript::result_t res;
+    node::jscript::JSInstance* instance{nullptr};
+    res = node::jscript::CreateInstance(&instance);
+    assert(res == node::jscript::JS_SUCCESS);
+    assert(instance != nullptr);
+    std::cout << "Instance created" << std::endl;
+
+    for (std::size_t i = 0; i < host_data.size(); ++i) {
+        host_data[i] = static_cast<uint8_t>(i);
+    }
+
+    auto release = [](void* data, std::size_t length) {
+        assert(data == host_data.data());
+        assert(length == host_data.size());
+        is_released = true;
+    };
+    res = node::jscript::SetGlobalBuffer(instance, "hostData", host_data.data(), host_data.size(), release);
+    assert(res == node::jscript::JS_SUCCESS);
+
+    const std::string script = ""
+        "const result = new Uint8Array(hostData.length);\n"
+        "for (let i = 0; i < hostData.length; ++i) {\n"
+        "    result[i] = 255 - hostData[i];\n"
+        "}\n"
+        "hostData[0] = 42;\n"
+        "resultDone(result);\n"
+        "";
+
+    node::jscript::JSCallbackInfo resultInfo;
+    resultInfo.name = "resultDone";
+    resultInfo.function = result_cb;
+
+    res = node::jscript::RunScriptText(instance, script, {resultInfo});
+    assert(res == node::jscript::JS_SUCCESS);
+
+    std::cout << "Script running, waiting..." << std::endl;
+    {
+        std::unique_lock<std::mutex> lock{result_mutex};
+        result_cv.wait(lock, [] { return is_result_done; });
+    }
+    std::cout << "Script done" << std::endl;
+
+    // Instance wrote into host memory
+    assert(host_data[0] == 42);
+
+    res = node::jscript::StopInstance(instance);
+    assert(res == node::jscript::JS_SUCCESS);
+    std::cout << "Instance stopped" << std::endl;
+
+    // Backing store is alive after instance stop
+    assert(result_view.length == host_data.size());
+    const uint8_t* result = static_cast<const uint8_t*>(result_view.data);
+    for (std::size_t i = 1; i < result_view.length; ++i) {
+        assert(result[i] == static_cast<uint8_t>(255 - static_cast<uint8_t>(i)));
+    }
+    result_view = node::jscript::BufferView{};
+
+    node::jscript::Uninitilize();
+    std::cout << "node::jscript::Uninitilize() done" << std::endl;
+
+    assert(is_released);
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,105 @@
+// Test for jscript Conan package manager
+// Message channel between instances, CreateChannel
+// Odant, 2021
+
+
+#ifdef NDEBUG
+#undef NDEBUG
+#endif
+
+#include <jscript.h>
+
+#include <iostream>
+#include <cstdlib>
+#include <string>
+#include <vector>
+#include <future>
+#include <filesystem>
+#include <cassert>
+
+
+struct ChannelResult {
+    int32_t count = 0;
+    double  byteLength = 0;
+    int32_t firstByte = 0;
+};
+
+static std::promise<ChannelResult> channel_promise;
+static void channel_cb(const v8::FunctionCallbackInfo<v8::Value>& args) {
+    v8::Local<v8::Context> context = args.GetIsolate()->GetCurrentContext();
+    ChannelResult result;
+    result.count = args[0]->Int32Value(context).FromJust();
+    result.byteLength = args[1]->NumberValue(context).FromJust();
+    result.firstByte = args[2]->Int32Value(context).FromJust();
+    channel_promise.set_value(result);
+}
+
+
+int main(int argc, char** argv) {
+
+    const std::string cwd = std::filesystem::current_path().string();
+    std::cout << "Current directory: " << cwd << std::endl;
+
+    const std::string origin = "http://127.0.0.1:8080";
+    const std::string externalOrigin = "http://127.0.0.1:8080";
+    const std::string executeFile = argv[0];
+    const std::string coreFolder = cwd;
+    const std::string nodeFolder = coreFolder + "/node_modules";
+
+    node::jscript::Initialize(origin, externalOrigin, executeFile, coreFolder, nodeFolder);
+    std::cout << "node::jscript::Initialize() done" << std::endl;
+
+    node::jscript::result_t res;
+    node::jscript::JSInstance* first{nullptr};
+    res = node::jscript::CreateInstance(&first);
+    assert(res == node::jscript::JS_SUCCESS);
+    node::jscript::JSInstance* second{nullptr};
+    res = node::jscript::CreateInstance(&second);
+    assert(res == node::jscript::JS_SUCCESS);
+    std::cout << "Instances created" << std::endl;
+
+    res = node::jscript::CreateChannel(first, "peer", second, "peer");
+    assert(res == node::jscript::JS_SUCCESS);
+    std::cout << "Channel created" << std::endl;
+
+    // Second instance increments counter and sends buffer back
+    node::jscript::ScriptResult result = node::jscript::RunScriptTextAsync(second,
+        "peer.on('message', (message) => {\n"
+        "  message.count += 1;\n"
+        "  new Uint8Array(message.buffer)[0] = 42;\n"
+        "  peer.postMessage(message, [message.buffer]);\n"
+        "});\n"
+        "typeof peer.postMessage;").get();
+    assert(result.status == node::jscript::JS_SUCCESS);
+    assert(result.value == "\"function\"");
+
+    node::jscript::JSCallbackInfo channelInfo;
+    channelInfo.name = "channelDone";
+    channelInfo.function = channel_cb;
+
+    // Buffer is transferred, not copied: it is detached in sender
+    result = node::jscript::RunScriptTextAsync(first,
+        "peer.on('message', (message) => {\n"
+        "  channelDone(message.count, message.buffer.byteLength, new Uint8Array(message.buffer)[0]);\n"
+        "});\n"
+        "const buffer = new ArrayBuffer(1024);\n"
+        "peer.postMessage({ count: 1, buffer }, [buffer]);\n"
+        "buffer.byteLength;", {channelInfo}).get();
+    assert(result.status == node::jscript::JS_SUCCESS);
+    assert(result.value == "0");
+
+    const ChannelResult channelResult = channel_promise.get_future().get();
+    std::cout << "Message received back, count: " << channelResult.count << std::endl;
+    assert(channelResult.count == 2);
+    assert(channelResult.byteLength == 1024);
+    assert(channelResult.firstByte == 42);
+
+    res = node::jscript::StopInstances({first, second});
+    assert(res == node::jscript::JS_SUCCESS);
+    std::cout << "Instances stopped" << std::endl;
+
+    node::jscript::Uninitilize();
+    std::cout << "node::jscript::Uninitilize() done" << std::endl;
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,109 @@
+// Test for jscript Conan package manager
+// Formatted console messages, SetConsoleMessageCallback
+// Odant, 2021
+
+
+#ifdef NDEBUG
+#undef NDEBUG
+#endif
+
+#include <jscript.h>
+
+#include <iostream>
+#include <cstdlib>
+#include <string>
+#include <vector>
+#include <mutex>
+#include <condition_variable>
+#include <filesystem>
+#include <cassert>
+
+
+static std::mutex messages_mutex;
+static std::condition_variable messages_cv;
+static std::vector<node::jscript::ConsoleMessage> messages;
+
+static void on_messages(const node::jscript::ConsoleMessage* batch, std::size_t count) {
+    std::unique_lock<std::mutex> lock{messages_mutex};
+    messages.insert(messages.end(), batch, batch + count);
+    messages_cv.notify_all();
+}
+
+
+int main(int argc, char** argv) {
+
+    const std::string cwd = std::filesystem::current_path().string();
+    std::cout << "Current directory: " << cwd << std::endl;
+
+    const std::string origin = "http://127.0.0.1:8080";
+    const std::string externalOrigin = "http://127.0.0.1:8080";
+    const std::string executeFile = argv[0];
+    const std::string coreFolder = cwd;
+    const std::string nodeFolder = coreFolder + "/node_modules";
+
+    node::jscript::Initialize(origin, externalOrigin, executeFile, coreFolder, nodeFolder);
+    std::cout << "node::jscript::Initialize() done" << std::endl;
+
+    node::jscript::result_t res;
+    node::jscript::JSInstance* instance{nullptr};
+    res = node::jscript::CreateInstance(&instance);
+    assert(res == node::jscript::JS_SUCCESS);
+    assert(instance != nullptr);
+    const uint64_t instanceId = node::jscript::GetInstanceId(instance);
+    std::cout << "Instance created, id: " << instanceId << std::endl;
+
+    // Delivery from instance thread
+    res = node::jscript::SetConsoleMessageCallback(instance, on_messages);
+    assert(res == node::jscript::JS_SUCCESS);
+
+    node::jscript::ScriptResult result = node::jscript::RunScriptTextAsync(instance,
+        "console.log('count: %d', 5, { x: 1 });\n"
+        "console.error('failed');").get();
+    assert(result.status == node::jscript::JS_SUCCESS);
+    {
+        std::unique_lock<std::mutex> lock{messages_mutex};
+        assert(messages.size() == 2);
+        std::cout << messages[0].text << std::endl;
+        assert(messages[0].text == "count: 5 { x: 1 }");
+        assert(messages[0].type == node::jscript::ConsoleType::Log);
+        assert(messages[0].instanceId == instanceId);
+        assert(messages[1].text == "failed");
+        assert(messages[1].type == node::jscript::ConsoleType::Error);
+        messages.clear();
+    }
+
+    // Batched delivery from dispatcher thread
+    node::jscript::ConsoleOptions options;
+    options.batched = true;
+    options.bufferSize = 64;
+    res = node::jscript::SetConsoleMessageCallback(instance, on_messages, options);
+    assert(res == node::jscript::JS_SUCCESS);
+
+    const std::size_t logs_count = 1000;
+    result = node::jscript::RunScriptTextAsync(instance,
+        "for (let i = 0; i < " + std::to_string(logs_count) + "; ++i) { console.warn('line', i); }").get();
+    assert(result.status == node::jscript::JS_SUCCESS);
+
+    // Small buffer overflows, dropped lines are reported
+    res = node::jscript::StopInstance(instance);
+    assert(res == node::jscript::JS_SUCCESS);
+    std::cout << "Instance stopped" << std::endl;
+    {
+        std::unique_lock<std::mutex> lock{messages_mutex};
+        std::cout << "Batched messages: " << messages.size() << std::endl;
+        assert(!messages.empty());
+        assert(messages.size() <= logs_count + 1);
+        assert(messages.front().text == "line 0");
+        for (const auto& message : messages) {
+            assert(message.instanceId == instanceId);
+            if (message.text.rfind("line ", 0) == 0) {
+                assert(message.type == node::jscript::ConsoleType::Warn);
+            }
+        }
+    }
+
+    node::jscript::Uninitilize();
+    std::cout << "node::jscript::Uninitilize() done" << std::endl;
+
+    return EXIT_SUCCESS;
+}
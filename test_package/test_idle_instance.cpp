@@ -0,0 +1,83 @@
+// Test for jscript Conan package manager
+// Idle instance hibernation, InstanceOptions::idleTimeout
+// Odant, 2021
+
+
+#ifdef NDEBUG
+#undef NDEBUG
+#endif
+
+#include <jscript.h>
+
+#include <iostream>
+#include <cstdlib>
+#include <string>
+#include <chrono>
+#include <thread>
+#include <filesystem>
+#include <cassert>
+
+
+int main(int argc, char** argv) {
+
+    const std::string cwd = std::filesystem::current_path().string();
+    std::cout << "Current directory: " << cwd << std::endl;
+
+    const std::string origin = "http://127.0.0.1:8080";
+    const std::string externalOrigin = "http://127.0.0.1:8080";
+    const std::string executeFile = argv[0];
+    const std::string coreFolder = cwd;
+    const std::string nodeFolder = coreFolder + "/node_modules";
+
+    node::jscript::Initialize(origin, externalOrigin, executeFile, coreFolder, nodeFolder);
+    std::cout << "node::jscript::Initialize() done" << std::endl;
+
+    node::jscript::result_t res;
+
+    node::jscript::InstanceOptions options;
+    options.idleTimeout = std::chrono::milliseconds{200};
+
+    node::jscript::JSInstance* instance{nullptr};
+    res = node::jscript::CreateInstance(options, &instance);
+    assert(res == node::jscript::JS_SUCCESS);
+    assert(instance != nullptr);
+    std::cout << "Instance with idle timeout created" << std::endl;
+
+    node::jscript::ScriptResult result = node::jscript::RunScriptTextAsync(instance,
+        "var garbage = [];\n"
+        "for (let i = 0; i < 100000; ++i) { garbage.push({ value: i }); }\n"
+        "garbage = null;\n"
+        "'allocated';").get();
+    assert(result.status == node::jscript::JS_SUCCESS);
+    assert(result.value == "\"allocated\"");
+
+    node::jscript::InstanceStats busyStats;
+    res = node::jscript::GetInstanceStats(instance, &busyStats);
+    assert(res == node::jscript::JS_SUCCESS);
+    std::cout << "Heap used before idle: " << busyStats.heapUsed << std::endl;
+
+    // Instance sleeps without timers, then idle policy compacts heap
+    std::this_thread::sleep_for(std::chrono::seconds{1});
+
+    node::jscript::InstanceStats idleStats;
+    res = node::jscript::GetInstanceStats(instance, &idleStats);
+    assert(res == node::jscript::JS_SUCCESS);
+    std::cout << "Heap used after idle: " << idleStats.heapUsed << std::endl;
+    assert(idleStats.gcCount > busyStats.gcCount);
+    assert(idleStats.heapUsed <= busyStats.heapUsed);
+
+    // Instance wakes up from hibernation on next script
+    result = node::jscript::RunScriptTextAsync(instance, "1 + 1").get();
+    assert(result.status == node::jscript::JS_SUCCESS);
+    assert(result.value == "2");
+    std::cout << "Instance woke up" << std::endl;
+
+    res = node::jscript::StopInstance(instance);
+    assert(res == node::jscript::JS_SUCCESS);
+    std::cout << "Instance stopped" << std::endl;
+
+    node::jscript::Uninitilize();
+    std::cout << "node::jscript::Uninitilize() done" << std::endl;
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,97 @@
+// Test for jscript Conan package manager
+// Per-instance heap limit and script timeout
+// Odant, 2021
+
+
+#ifdef NDEBUG
+#undef NDEBUG
+#endif
+
+#include <jscript.h>
+
+#include <iostream>
+#include <cstdlib>
+#include <string>
+#include <filesystem>
+#include <cassert>
+
+
+static void check_alive(node::jscript::JSInstance* instance) {
+    node::jscript::ScriptResult result = node::jscript::RunScriptTextAsync(instance, "1 + 1").get();
+    assert(result.status == node::jscript::JS_SUCCESS);
+    assert(result.value == "2");
+}
+
+
+int main(int argc, char** argv) {
+
+    const std::string cwd = std::filesystem::current_path().string();
+    std::cout << "Current directory: " << cwd << std::endl;
+
+    const std::string origin = "http://127.0.0.1:8080";
+    const std::string externalOrigin = "http://127.0.0.1:8080";
+    const std::string executeFile = argv[0];
+    const std::string coreFolder = cwd;
+    const std::string nodeFolder = coreFolder + "/node_modules";
+
+    node::jscript::Initialize(origin, externalOrigin, executeFile, coreFolder, nodeFolder);
+    std::cout << "node::jscript::Initialize() done" << std::endl;
+
+    node::jscript::result_t res;
+
+    // Script timeout
+    {
+        node::jscript::InstanceOptions options;
+        options.scriptTimeout = std::chrono::milliseconds{500};
+
+        node::jscript::JSInstance* instance{nullptr};
+        res = node::jscript::CreateInstance(options, &instance);
+        assert(res == node::jscript::JS_SUCCESS);
+        assert(instance != nullptr);
+        std::cout << "Instance with script timeout created" << std::endl;
+
+        check_alive(instance);
+
+        node::jscript::ScriptResult result = node::jscript::RunScriptTextAsync(instance, "while (true) {}").get();
+        assert(result.status == node::jscript::JS_ERROR);
+        std::cout << "Endless loop: " << result.exception << std::endl;
+        assert(result.exception.find("timed out") != std::string::npos);
+
+        check_alive(instance);
+
+        res = node::jscript::StopInstance(instance);
+        assert(res == node::jscript::JS_SUCCESS);
+        std::cout << "Instance stopped" << std::endl;
+    }
+
+    // Heap limit
+    {
+        node::jscript::InstanceOptions options;
+        options.maxHeapSize = 128 * 1024 * 1024;
+
+        node::jscript::JSInstance* instance{nullptr};
+        res = node::jscript::CreateInstance(options, &instance);
+        assert(res == node::jscript::JS_SUCCESS);
+        assert(instance != nullptr);
+        std::cout << "Instance with heap limit created" << std::endl;
+
+        node::jscript::ScriptResult result = node::jscript::RunScriptTextAsync(instance,
+            "var leak = [];\n"
+            "while (true) { leak.push(new Array(1024).fill(leak.length)); }").get();
+        assert(result.status == node::jscript::JS_ERROR);
+        std::cout << "Heap exhaustion: " << result.exception << std::endl;
+        assert(result.exception.find("heap limit") != std::string::npos);
+
+        node::jscript::RunScriptText(instance, "leak = undefined;");
+        check_alive(instance);
+
+        res = node::jscript::StopInstance(instance);
+        assert(res == node::jscript::JS_SUCCESS);
+        std::cout << "Instance stopped" << std::endl;
+    }
+
+    node::jscript::Uninitilize();
+    std::cout << "node::jscript::Uninitilize() done" << std::endl;
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,85 @@
+// Test for jscript Conan package manager
+// Pool of ready instances, AcquireInstance
+// Odant, 2021
+
+
+#ifdef NDEBUG
+#undef NDEBUG
+#endif
+
+#include <jscript.h>
+
+#include <iostream>
+#include <cstdlib>
+#include <string>
+#include <vector>
+#include <thread>
+#include <chrono>
+#include <filesystem>
+#include <cassert>
+
+
+static void wait_ready(std::size_t count) {
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds{60};
+    while (node::jscript::GetInstancePoolStats().ready < count) {
+        assert(std::chrono::steady_clock::now() < deadline);
+        std::this_thread::sleep_for(std::chrono::milliseconds{10});
+    }
+}
+
+
+int main(int argc, char** argv) {
+
+    const std::string cwd = std::filesystem::current_path().string();
+    std::cout << "Current directory: " << cwd << std::endl;
+
+    const std::string origin = "http://127.0.0.1:8080";
+    const std::string externalOrigin = "http://127.0.0.1:8080";
+    const std::string executeFile = argv[0];
+    const std::string coreFolder = cwd;
+    const std::string nodeFolder = coreFolder + "/node_modules";
+
+    node::jscript::Initialize(origin, externalOrigin, executeFile, coreFolder, nodeFolder);
+    std::cout << "node::jscript::Initialize() done" << std::endl;
+
+    node::jscript::SetInstancePoolSize(2);
+    wait_ready(2);
+    std::cout << "Pool filled" << std::endl;
+
+    node::jscript::result_t res;
+    std::vector<node::jscript::JSInstance*> instances;
+    for (int i = 0; i < 3; ++i) {
+        node::jscript::JSInstance* instance{nullptr};
+        res = node::jscript::AcquireInstance(&instance);
+        assert(res == node::jscript::JS_SUCCESS);
+        assert(instance != nullptr);
+        instances.push_back(instance);
+    }
+
+    node::jscript::InstancePoolStats stats = node::jscript::GetInstancePoolStats();
+    std::cout << "Pool hits: " << stats.hits << ", misses: " << stats.misses << std::endl;
+    assert(stats.hits == 2);
+    assert(stats.misses == 1);
+
+    for (node::jscript::JSInstance* instance : instances) {
+        const node::jscript::ScriptResult result = node::jscript::RunScriptTextAsync(instance, "6 * 7").get();
+        assert(result.status == node::jscript::JS_SUCCESS);
+        assert(result.value == "42");
+    }
+
+    for (node::jscript::JSInstance* instance : instances) {
+        res = node::jscript::StopInstance(instance);
+        assert(res == node::jscript::JS_SUCCESS);
+    }
+    std::cout << "Instances stopped" << std::endl;
+
+    // Refilled, threads of stopped instances are reused
+    wait_ready(2);
+    stats = node::jscript::GetInstancePoolStats();
+    std::cout << "Pool refilled, recycled threads: " << stats.recycledThreads << std::endl;
+
+    node::jscript::Uninitilize();
+    std::cout << "node::jscript::Uninitilize() done" << std::endl;
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,101 @@
+// Test for jscript Conan package manager
+// Instance metrics, GetInstanceStats
+// Odant, 2021
+
+
+#ifdef NDEBUG
+#undef NDEBUG
+#endif
+
+#include <jscript.h>
+
+#include <iostream>
+#include <cstdlib>
+#include <string>
+#include <vector>
+#include <future>
+#include <filesystem>
+#include <cassert>
+
+
+static void print_stats(const node::jscript::InstanceStats& stats) {
+    std::cout << "loopUtilization: " << stats.loopUtilization
+              << ", queueDepth: " << stats.queueDepth
+              << ", scriptsExecuted: " << stats.scriptsExecuted
+              << ", heapUsed: " << stats.heapUsed
+              << ", heapLimit: " << stats.heapLimit
+              << ", gcCount: " << stats.gcCount
+              << ", gcPauseTotal: " << stats.gcPauseTotal.count() << "us"
+              << ", latencyCount: " << stats.latencyCount
+              << ", latencyP50: " << stats.latencyP50.count() << "us"
+              << ", latencyP99: " << stats.latencyP99.count() << "us"
+              << std::endl;
+}
+
+
+int main(int argc, char** argv) {
+
+    const std::string cwd = std::filesystem::current_path().string();
+    std::cout << "Current directory: " << cwd << std::endl;
+
+    const std::string origin = "http://127.0.0.1:8080";
+    const std::string externalOrigin = "http://127.0.0.1:8080";
+    const std::string executeFile = argv[0];
+    const std::string coreFolder = cwd;
+    const std::string nodeFolder = coreFolder + "/node_modules";
+
+    node::jscript::Initialize(origin, externalOrigin, executeFile, coreFolder, nodeFolder);
+    std::cout << "node::jscript::Initialize() done" << std::endl;
+
+    node::jscript::result_t res;
+    node::jscript::JSInstance* instance{nullptr};
+    res = node::jscript::CreateInstance(&instance);
+    assert(res == node::jscript::JS_SUCCESS);
+    assert(instance != nullptr);
+    std::cout << "Instance created" << std::endl;
+
+    node::jscript::InstanceStats stats;
+    res = node::jscript::GetInstanceStats(instance, &stats);
+    assert(res == node::jscript::JS_SUCCESS);
+    print_stats(stats);
+
+    const std::size_t scripts_count = 100;
+    std::vector<std::future<node::jscript::ScriptResult>> results;
+    for (std::size_t i = 0; i < scripts_count; ++i) {
+        results.push_back(node::jscript::RunScriptTextAsync(instance,
+            "var garbage = 0;\n"
+            "for (let i = 0; i < 10000; ++i) { garbage += new Array(100).length; }\n"
+            "garbage;"));
+    }
+    for (auto& result : results) {
+        assert(result.get().status == node::jscript::JS_SUCCESS);
+    }
+
+    res = node::jscript::GetInstanceStats(instance, &stats);
+    assert(res == node::jscript::JS_SUCCESS);
+    print_stats(stats);
+    assert(stats.queueDepth == 0);
+    assert(stats.scriptsExecuted >= scripts_count);
+    assert(stats.latencyCount >= scripts_count);
+    assert(stats.latencyP50 <= stats.latencyP99);
+    assert(stats.latencyP99 <= stats.latencyMax);
+    assert(stats.heapUsed > 0 && stats.heapUsed <= stats.heapTotal);
+    assert(stats.heapLimit > 0);
+    assert(stats.gcCount > 0);
+    assert(stats.loopActiveTime.count() > 0);
+    assert(stats.loopUtilization > 0 && stats.loopUtilization <= 1);
+
+    // Latency is reported for period since previous call
+    res = node::jscript::GetInstanceStats(instance, &stats);
+    assert(res == node::jscript::JS_SUCCESS);
+    assert(stats.latencyCount == 0);
+
+    res = node::jscript::StopInstance(instance);
+    assert(res == node::jscript::JS_SUCCESS);
+    std::cout << "Instance stopped" << std::endl;
+
+    node::jscript::Uninitilize();
+    std::cout << "node::jscript::Uninitilize() done" << std::endl;
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,90 @@
+// Test for jscript Conan package manager
+// Many instances on shared event loop threads, SetLoopThreads
+// Odant, 2021
+
+
+#ifdef NDEBUG
+#undef NDEBUG
+#endif
+
+#include <jscript.h>
+
+#include <iostream>
+#include <cstdlib>
+#include <string>
+#include <vector>
+#include <mutex>
+#include <condition_variable>
+#include <filesystem>
+#include <cassert>
+
+
+static const std::size_t instances_count = 8;
+
+static std::size_t timers_done = 0;
+static std::mutex timers_mutex;
+static std::condition_variable timers_cv;
+static void timer_cb(const v8::FunctionCallbackInfo<v8::Value>&) {
+    std::unique_lock<std::mutex> lock{timers_mutex};
+    ++timers_done;
+    timers_cv.notify_all();
+}
+
+
+int main(int argc, char** argv) {
+
+    const std::string cwd = std::filesystem::current_path().string();
+    std::cout << "Current directory: " << cwd << std::endl;
+
+    const std::string origin = "http://127.0.0.1:8080";
+    const std::string externalOrigin = "http://127.0.0.1:8080";
+    const std::string executeFile = argv[0];
+    const std::string coreFolder = cwd;
+    const std::string nodeFolder = coreFolder + "/node_modules";
+
+    node::jscript::Initialize(origin, externalOrigin, executeFile, coreFolder, nodeFolder);
+    std::cout << "node::jscript::Initialize() done" << std::endl;
+
+    node::jscript::SetLoopThreads(2);
+
+    node::jscript::result_t res;
+    std::vector<node::jscript::JSInstance*> instances;
+    for (std::size_t i = 0; i < instances_count; ++i) {
+        node::jscript::JSInstance* instance{nullptr};
+        res = node::jscript::CreateInstance(&instance);
+        assert(res == node::jscript::JS_SUCCESS);
+        assert(instance != nullptr);
+        instances.push_back(instance);
+    }
+    std::cout << "Instances created: " << instances.size() << std::endl;
+
+    node::jscript::JSCallbackInfo timerInfo;
+    timerInfo.name = "timerDone";
+    timerInfo.function = timer_cb;
+
+    for (std::size_t i = 0; i < instances.size(); ++i) {
+        const std::string script = "setTimeout(timerDone, 100);\n"
+                                   "var id = " + std::to_string(i) + ";\n"
+                                   "id * 2;";
+        node::jscript::ScriptResult result = node::jscript::RunScriptTextAsync(instances[i], script, {timerInfo}).get();
+        assert(result.status == node::jscript::JS_SUCCESS);
+        assert(result.value == std::to_string(i * 2));
+    }
+
+    {
+        std::unique_lock<std::mutex> lock{timers_mutex};
+        timers_cv.wait(lock, [] { return timers_done == instances_count; });
+    }
+    std::cout << "Timers done: " << timers_done << std::endl;
+
+    for (node::jscript::JSInstance* instance : instances) {
+        res = node::jscript::StopInstance(instance);
+        assert(res == node::jscript::JS_SUCCESS);
+    }
+    std::cout << "Instances stopped" << std::endl;
+
+    node::jscript::Uninitilize();
+    std::cout << "node::jscript::Uninitilize() done" << std::endl;
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,89 @@
+// Test for jscript Conan package manager
+// Module code cache shared by instances
+// Odant, 2021
+
+
+#ifdef NDEBUG
+#undef NDEBUG
+#endif
+
+#include <jscript.h>
+
+#include <iostream>
+#include <cstdlib>
+#include <string>
+#include <vector>
+#include <filesystem>
+#include <cassert>
+
+
+static void run_modules(node::jscript::JSInstance* instance) {
+    // CommonJS loader
+    node::jscript::ScriptResult result = node::jscript::RunScriptTextAsync(instance,
+        "require('module2').foobar()").get();
+    assert(result.status == node::jscript::JS_SUCCESS);
+    assert(result.value == "42");
+
+    // Same source compiled by vm, cached data of caller has priority over shared cache
+    result = node::jscript::RunScriptTextAsync(instance,
+        "const vm = require('vm');\n"
+        "const fn = vm.compileFunction('return a + b;', ['a', 'b'], { produceCachedData: true });\n"
+        "const cached = vm.compileFunction('return a + b;', ['a', 'b'], { cachedData: fn.cachedData });\n"
+        "fn(40, 2) === cached(40, 2) ? fn(40, 2) : -1").get();
+    assert(result.status == node::jscript::JS_SUCCESS);
+    assert(result.value == "42");
+}
+
+
+int main(int argc, char** argv) {
+
+    const std::string cwd = std::filesystem::current_path().string();
+    std::cout << "Current directory: " << cwd << std::endl;
+
+    const std::string origin = "http://127.0.0.1:8080";
+    const std::string externalOrigin = "http://127.0.0.1:8080";
+    const std::string executeFile = argv[0];
+    const std::string coreFolder = cwd;
+    const std::vector<std::string> nodeFolders = {
+        coreFolder + "/node_modules",
+        coreFolder + "/node_modules2"
+    };
+
+    node::jscript::Initialize(origin, externalOrigin, executeFile, coreFolder, nodeFolders);
+    std::cout << "node::jscript::Initialize() done" << std::endl;
+
+    node::jscript::result_t res;
+
+    // First instance fills cache, second one consumes it
+    for (int i = 0; i < 2; ++i) {
+        node::jscript::JSInstance* instance{nullptr};
+        res = node::jscript::CreateInstance(&instance);
+        assert(res == node::jscript::JS_SUCCESS);
+        assert(instance != nullptr);
+
+        run_modules(instance);
+        std::cout << "Modules loaded by instance " << i << std::endl;
+
+        res = node::jscript::StopInstance(instance);
+        assert(res == node::jscript::JS_SUCCESS);
+    }
+
+    // Disabled cache
+    node::jscript::SetModuleCacheLimit(0);
+    {
+        node::jscript::JSInstance* instance{nullptr};
+        res = node::jscript::CreateInstance(&instance);
+        assert(res == node::jscript::JS_SUCCESS);
+
+        run_modules(instance);
+        std::cout << "Modules loaded without cache" << std::endl;
+
+        res = node::jscript::StopInstance(instance);
+        assert(res == node::jscript::JS_SUCCESS);
+    }
+
+    node::jscript::Uninitilize();
+    std::cout << "node::jscript::Uninitilize() done" << std::endl;
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,95 @@
+// Test for jscript Conan package manager
+// CPU profile and heap snapshot of running instance
+// Odant, 2021
+
+
+#ifdef NDEBUG
+#undef NDEBUG
+#endif
+
+#include <jscript.h>
+
+#include <iostream>
+#include <cstdlib>
+#include <string>
+#include <filesystem>
+#include <cassert>
+
+
+int main(int argc, char** argv) {
+
+    const std::string cwd = std::filesystem::current_path().string();
+    std::cout << "Current directory: " << cwd << std::endl;
+
+    const std::string origin = "http://127.0.0.1:8080";
+    const std::string externalOrigin = "http://127.0.0.1:8080";
+    const std::string executeFile = argv[0];
+    const std::string coreFolder = cwd;
+    const std::string nodeFolder = coreFolder + "/node_modules";
+
+    node::jscript::Initialize(origin, externalOrigin, executeFile, coreFolder, nodeFolder);
+    std::cout << "node::jscript::Initialize() done" << std::endl;
+
+    node::jscript::result_t res;
+    node::jscript::JSInstance* instance{nullptr};
+    res = node::jscript::CreateInstance(&instance);
+    assert(res == node::jscript::JS_SUCCESS);
+    assert(instance != nullptr);
+    std::cout << "Instance created" << std::endl;
+
+    // Not started
+
+    assert(node::jscript::StopCpuProfile(instance).get().empty());
+
+    // CPU profile
+
+    res = node::jscript::StartCpuProfile(instance, std::chrono::microseconds{100});
+    assert(res == node::jscript::JS_SUCCESS);
+
+    const node::jscript::ScriptResult result = node::jscript::RunScriptTextAsync(instance,
+        "function fib(n) { return n < 2 ? n : fib(n - 1) + fib(n - 2); }\n"
+        "fib(25)").get();
+    assert(result.status == node::jscript::JS_SUCCESS);
+
+    const std::string profile = node::jscript::StopCpuProfile(instance).get();
+    std::cout << "CPU profile: " << profile.size() << " bytes" << std::endl;
+    assert(profile.find("{\"nodes\":[") == 0);
+    assert(profile.find("\"functionName\":\"fib\"") != std::string::npos);
+    assert(profile.find("\"samples\":[") != std::string::npos);
+    assert(profile.find("\"timeDeltas\":[") != std::string::npos);
+
+    // Heap snapshot
+
+    std::string snapshot;
+    std::size_t chunks = 0;
+    res = node::jscript::WriteHeapSnapshot(instance, [&snapshot, &chunks](const char* data, std::size_t size) {
+        snapshot.append(data, size);
+        ++chunks;
+        return true;
+    }).get();
+    std::cout << "Heap snapshot: " << snapshot.size() << " bytes, " << chunks << " chunks" << std::endl;
+    assert(res == node::jscript::JS_SUCCESS);
+    assert(snapshot.find("{\"snapshot\":") == 0);
+    assert(chunks > 1);
+
+    // Aborted by sink
+
+    res = node::jscript::WriteHeapSnapshot(instance, [](const char*, std::size_t) {
+        return false;
+    }).get();
+    assert(res == node::jscript::JS_ERROR);
+
+    // Started profile is dropped by stop
+
+    res = node::jscript::StartCpuProfile(instance);
+    assert(res == node::jscript::JS_SUCCESS);
+
+    res = node::jscript::StopInstance(instance);
+    assert(res == node::jscript::JS_SUCCESS);
+    std::cout << "Instance stopped" << std::endl;
+
+    node::jscript::Uninitilize();
+    std::cout << "node::jscript::Uninitilize() done" << std::endl;
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,117 @@
+// Test for jscript Conan package manager
+// fs.readFile and fs.writeFile of path as single native request, callback and promise API
+// Odant, 2021
+
+
+#ifdef NDEBUG
+#undef NDEBUG
+#endif
+
+#include <jscript.h>
+
+#include <iostream>
+#include <cstdlib>
+#include <string>
+#include <mutex>
+#include <condition_variable>
+#include <filesystem>
+#include <cassert>
+
+
+static std::mutex done_mutex;
+static std::condition_variable done_cv;
+static bool is_done = false;
+static std::string done_result;
+static void done_cb(const v8::FunctionCallbackInfo<v8::Value>& args) {
+    v8::String::Utf8Value value(args.GetIsolate(), args[0]);
+    std::unique_lock<std::mutex> lock{done_mutex};
+    done_result = *value ? *value : "";
+    is_done = true;
+    done_cv.notify_all();
+}
+
+// Every check adds its name on failure, 'ok' is reported when all passed
+static const char* const test_script =
+    "const fs = require('fs');\n"
+    "const failed = [];\n"
+    "const check = (name, value) => { if (!value) failed.push(name); };\n"
+    "const text = 'read file \\u00e9\\n'.repeat(1000);\n"
+    "fs.writeFile('test_read_file.txt', text, (err) => {\n"
+    "  check('write', err === null);\n"
+    "  fs.readFile('test_read_file.txt', (err, data) => {\n"
+    "    check('read buffer', err === null && Buffer.isBuffer(data) && data.toString() === text);\n"
+    "    fs.readFile('test_read_file.txt', 'utf8', (err, data) => {\n"
+    "      check('read string', err === null && data === text);\n"
+    "      fs.readFile('test_read_file_missing.txt', (err) => {\n"
+    "        check('missing', err && err.code === 'ENOENT' && err.syscall === 'open' &&\n"
+    "                         err.path.endsWith('test_read_file_missing.txt'));\n"
+    "        fs.readFile('.', (err) => {\n"
+    "          check('directory', err && err.code === 'EISDIR');\n"
+    "          runPromises().then(() => fileDone(failed.length ? failed.join() : 'ok'),\n"
+    "                             (err) => fileDone(String(err)));\n"
+    "        });\n"
+    "      });\n"
+    "    });\n"
+    "  });\n"
+    "});\n"
+    "async function runPromises() {\n"
+    "  const fsp = fs.promises;\n"
+    "  await fsp.writeFile('test_read_file.txt', Buffer.from(text));\n"
+    "  await fsp.appendFile('test_read_file.txt', new Uint8Array([0x41, 0x42]));\n"
+    "  check('promise read', (await fsp.readFile('test_read_file.txt', 'latin1')) ===\n"
+    "                        Buffer.from(text).toString('latin1') + 'AB');\n"
+    "  await fsp.writeFile('test_read_file.txt', '');\n"
+    "  const empty = await fsp.readFile('test_read_file.txt');\n"
+    "  check('promise empty', Buffer.isBuffer(empty) && empty.length === 0);\n"
+    "  await fsp.readFile('test_read_file_missing.txt').then(() => check('promise missing', false),\n"
+    "                                                     (err) => check('promise missing', err.code === 'ENOENT'));\n"
+    "  if (process.platform === 'linux') {\n"
+    "    // Size of proc files is 0, they are read until end of file\n"
+    "    check('unknown size', (await fsp.readFile('/proc/self/status', 'utf8')).includes('Name:'));\n"
+    "  }\n"
+    "  fs.unlinkSync('test_read_file.txt');\n"
+    "}\n";
+
+
+int main(int argc, char** argv) {
+
+    const std::string cwd = std::filesystem::current_path().string();
+    std::cout << "Current directory: " << cwd << std::endl;
+
+    const std::string origin = "http://127.0.0.1:8080";
+    const std::string externalOrigin = "http://127.0.0.1:8080";
+    const std::string executeFile = argv[0];
+    const std::string coreFolder = cwd;
+    const std::string nodeFolder = coreFolder + "/node_modules";
+
+    node::jscript::Initialize(origin, externalOrigin, executeFile, coreFolder, nodeFolder);
+    std::cout << "node::jscript::Initialize() done" << std::endl;
+
+    node::jscript::result_t res;
+    node::jscript::JSInstance* instance{nullptr};
+    res = node::jscript::CreateInstance(&instance);
+    assert(res == node::jscript::JS_SUCCESS);
+    assert(instance != nullptr);
+    std::cout << "Instance created" << std::endl;
+
+    node::jscript::JSCallbackInfo callbackInfo;
+    callbackInfo.name = "fileDone";
+    callbackInfo.function = done_cb;
+    res = node::jscript::RunScriptText(instance, test_script, {callbackInfo});
+    assert(res == node::jscript::JS_SUCCESS);
+
+    std::unique_lock<std::mutex> lock{done_mutex};
+    done_cv.wait(lock, [] { return is_done; });
+    lock.unlock();
+    std::cout << "Result: " << done_result << std::endl;
+    assert(done_result == "ok");
+
+    res = node::jscript::StopInstance(instance);
+    assert(res == node::jscript::JS_SUCCESS);
+    std::cout << "Instance stopped" << std::endl;
+
+    node::jscript::Uninitilize();
+    std::cout << "node::jscript::Uninitilize() done" << std::endl;
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,88 @@
+// Test for jscript Conan package manager
+// Persistent host functions, RegisterCallbacks and RegisterGlobalCallbacks
+// Odant, 2021
+
+
+#ifdef NDEBUG
+#undef NDEBUG
+#endif
+
+#include <jscript.h>
+
+#include <iostream>
+#include <cstdlib>
+#include <string>
+#include <filesystem>
+#include <cassert>
+
+
+static void host_add(const v8::FunctionCallbackInfo<v8::Value>& args) {
+    v8::Local<v8::Context> context = args.GetIsolate()->GetCurrentContext();
+    const double result = args[0]->NumberValue(context).FromJust() + args[1]->NumberValue(context).FromJust();
+    args.GetReturnValue().Set(result);
+}
+
+static void host_mul(const v8::FunctionCallbackInfo<v8::Value>& args) {
+    v8::Local<v8::Context> context = args.GetIsolate()->GetCurrentContext();
+    const double factor = *static_cast<const double*>(args.Data().As<v8::External>()->Value());
+    args.GetReturnValue().Set(args[0]->NumberValue(context).FromJust() * factor);
+}
+
+
+int main(int argc, char** argv) {
+
+    const std::string cwd = std::filesystem::current_path().string();
+    std::cout << "Current directory: " << cwd << std::endl;
+
+    const std::string origin = "http://127.0.0.1:8080";
+    const std::string externalOrigin = "http://127.0.0.1:8080";
+    const std::string executeFile = argv[0];
+    const std::string coreFolder = cwd;
+    const std::string nodeFolder = coreFolder + "/node_modules";
+
+    node::jscript::Initialize(origin, externalOrigin, executeFile, coreFolder, nodeFolder);
+    std::cout << "node::jscript::Initialize() done" << std::endl;
+
+    node::jscript::JSCallbackInfo addInfo;
+    addInfo.name = "hostAdd";
+    addInfo.function = host_add;
+    node::jscript::RegisterGlobalCallbacks({addInfo});
+
+    node::jscript::result_t res;
+    node::jscript::JSInstance* instance{nullptr};
+    res = node::jscript::CreateInstance(&instance);
+    assert(res == node::jscript::JS_SUCCESS);
+    assert(instance != nullptr);
+    std::cout << "Instance created" << std::endl;
+
+    static double factor = 3;
+    node::jscript::JSCallbackInfo mulInfo;
+    mulInfo.name = "hostMul";
+    mulInfo.function = host_mul;
+    mulInfo.external = &factor;
+    res = node::jscript::RegisterCallbacks(instance, {mulInfo});
+    assert(res == node::jscript::JS_SUCCESS);
+
+    node::jscript::ScriptResult result = node::jscript::RunScriptTextAsync(instance,
+        "globalThis.savedMul = hostMul;\n"
+        "let sum = 0;\n"
+        "for (let i = 0; i < 100000; ++i) { sum = hostAdd(sum, hostMul(1)); }\n"
+        "sum;").get();
+    assert(result.status == node::jscript::JS_SUCCESS);
+    std::cout << "Result: " << result.value << std::endl;
+    assert(result.value == "300000");
+
+    // Same callback passed with script is not re-bound
+    result = node::jscript::RunScriptTextAsync(instance, "savedMul === hostMul", {mulInfo}).get();
+    assert(result.status == node::jscript::JS_SUCCESS);
+    assert(result.value == "true");
+
+    res = node::jscript::StopInstance(instance);
+    assert(res == node::jscript::JS_SUCCESS);
+    std::cout << "Instance stopped" << std::endl;
+
+    node::jscript::Uninitilize();
+    std::cout << "node::jscript::Uninitilize() done" << std::endl;
+
+    return EXIT_SUCCESS;
+}
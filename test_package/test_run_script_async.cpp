@@ -0,0 +1,110 @@
+// Test for jscript Conan package manager
+// RunScriptTextAsync and RunScriptText with completion callback
+// Odant, 2021
+
+
+#ifdef NDEBUG
+#undef NDEBUG
+#endif
+
+#include <jscript.h>
+
+#include <iostream>
+#include <cstdlib>
+#include <string>
+#include <vector>
+#include <future>
+#include <mutex>
+#include <condition_variable>
+#include <filesystem>
+#include <cassert>
+
+
+int main(int argc, char** argv) {
+
+    const std::string cwd = std::filesystem::current_path().string();
+    std::cout << "Current directory: " << cwd << std::endl;
+
+    const std::string origin = "http://127.0.0.1:8080";
+    const std::string externalOrigin = "http://127.0.0.1:8080";
+    const std::string executeFile = argv[0];
+    const std::string coreFolder = cwd;
+    const std::string nodeFolder = coreFolder + "/node_modules";
+
+    node::jscript::Initialize(origin, externalOrigin, executeFile, coreFolder, nodeFolder);
+    std::cout << "node::jscript::Initialize() done" << std::endl;
+
+    node::jscript::result_t res;
+    node::jscript::JSInstance* instance{nullptr};
+    res = node::jscript::CreateInstance(&instance);
+    assert(res == node::jscript::JS_SUCCESS);
+    assert(instance != nullptr);
+    std::cout << "Instance created" << std::endl;
+
+    // Pipelined scripts with futures
+
+    std::vector<std::future<node::jscript::ScriptResult>> futures;
+    for (int i = 0; i < 100; ++i) {
+        futures.push_back(node::jscript::RunScriptTextAsync(instance, "({ index: " + std::to_string(i) + " })"));
+    }
+    for (int i = 0; i < 100; ++i) {
+        const node::jscript::ScriptResult result = futures[i].get();
+        assert(result.status == node::jscript::JS_SUCCESS);
+        assert(result.value == "{\"index\":" + std::to_string(i) + "}");
+        assert(result.exception.empty());
+    }
+    std::cout << "Futures resolved" << std::endl;
+
+    // Exception
+
+    {
+        const node::jscript::ScriptResult result = node::jscript::RunScriptTextAsync(instance, "throw new Error('Error42');").get();
+        std::cout << "Exception: " << result.exception << std::endl;
+        assert(result.status == node::jscript::JS_ERROR);
+        assert(result.exception.find("Error42") != std::string::npos);
+    }
+
+    // Compile error
+
+    {
+        const node::jscript::ScriptResult result = node::jscript::RunScriptTextAsync(instance, "compile failed zzzzzzzzz").get();
+        std::cout << "Compile error: " << result.exception << std::endl;
+        assert(result.status == node::jscript::JS_ERROR);
+        assert(!result.exception.empty());
+    }
+
+    // Completion callback
+
+    {
+        std::mutex mtx;
+        std::condition_variable cv;
+        bool isDone = false;
+        node::jscript::ScriptResult completionResult;
+
+        auto completion = [&](node::jscript::ScriptResult result) {
+            std::unique_lock<std::mutex> lock{mtx};
+            completionResult = std::move(result);
+            isDone = true;
+            cv.notify_all();
+        };
+
+        res = node::jscript::RunScriptText(instance, "'string result'", {}, completion);
+        assert(res == node::jscript::JS_SUCCESS);
+
+        std::unique_lock<std::mutex> lock{mtx};
+        cv.wait(lock, [&isDone] { return isDone; });
+
+        assert(completionResult.status == node::jscript::JS_SUCCESS);
+        assert(completionResult.value == "\"string result\"");
+        std::cout << "Completion callback done, run time: " << completionResult.runTime.count() << " us" << std::endl;
+    }
+
+    res = node::jscript::StopInstance(instance);
+    assert(res == node::jscript::JS_SUCCESS);
+    std::cout << "Instance stopped" << std::endl;
+
+    node::jscript::Uninitilize();
+    std::cout << "node::jscript::Uninitilize() done" << std::endl;
+
+    return EXIT_SUCCESS;
+}
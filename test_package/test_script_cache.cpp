@@ -0,0 +1,114 @@
+// Test for jscript Conan package manager
+// Repeated RunScriptText payloads with compiled scripts cache
+// Odant, 2021
+
+
+#include <jscript.h>
+
+#include <iostream>
+#include <cstdlib>
+#include <string>
+#include <vector>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <filesystem>
+
+
+static const std::size_t repeat_count = 100;
+
+static std::atomic_size_t scripts_done{0};
+static std::mutex script_mutex;
+static std::condition_variable script_cv;
+static void script_cb(const v8::FunctionCallbackInfo<v8::Value>& args) {
+    std::unique_lock<std::mutex> lock{script_mutex};
+    if (args.Length() == 1 && args[0]->IsNumber()) {
+        ++scripts_done;
+    }
+    script_cv.notify_all();
+}
+
+static void run_scripts(node::jscript::JSInstance* instance, const std::string& script) {
+    node::jscript::JSCallbackInfo resolveInfo;
+    resolveInfo.name = "scriptDone";
+    resolveInfo.function = script_cb;
+
+    const std::vector<node::jscript::JSCallbackInfo> callbacks{
+        std::move(resolveInfo)
+    };
+
+    scripts_done = 0;
+    for (std::size_t i = 0; i < repeat_count; ++i) {
+        const auto res = node::jscript::RunScriptText(instance, script, callbacks);
+        if (res != node::jscript::JS_SUCCESS) {
+            std::cout << "Failed running script" << std::endl;
+            std::exit(EXIT_FAILURE);
+        }
+    }
+
+    std::unique_lock<std::mutex> script_lock{script_mutex};
+    script_cv.wait(script_lock, [] { return scripts_done == repeat_count; });
+}
+
+static node::jscript::JSInstance* create_instance() {
+    node::jscript::JSInstance* instance{nullptr};
+    const auto res = node::jscript::CreateInstance(&instance);
+    if (res != node::jscript::JS_SUCCESS || !instance) {
+        std::cout << "Failed instance create" << std::endl;
+        std::exit(EXIT_FAILURE);
+    }
+    return instance;
+}
+
+static void stop_instance(node::jscript::JSInstance* instance) {
+    const auto res = node::jscript::StopInstance(instance);
+    if (res != node::jscript::JS_SUCCESS) {
+        std::cout << "Failed instance stop" << std::endl;
+        std::exit(EXIT_FAILURE);
+    }
+}
+
+
+int main(int argc, char** argv) {
+
+    const std::string cwd = std::filesystem::current_path().string();
+    std::cout << "Current directory: " << cwd << std::endl;
+
+    const std::string origin = "http://127.0.0.1:8080";
+    const std::string externalOrigin = "http://127.0.0.1:8080";
+    const std::string executeFile = argv[0];
+    const std::string coreFolder = cwd;
+    const std::string nodeFolder = coreFolder + "/node_modules";
+
+    node::jscript::Initialize(origin, externalOrigin, executeFile, coreFolder, nodeFolder);
+    std::cout << "node::jscript::Initialize() done" << std::endl;
+
+    const std::string script = ""
+        "function fib(n) { return n < 2 ? n : fib(n - 1) + fib(n - 2); }\n"
+        "scriptDone(fib(15));\n"
+        "";
+
+    // Cold instance fills per-instance and process caches
+    node::jscript::JSInstance* instance1 = create_instance();
+    run_scripts(instance1, script);
+    std::cout << "First instance scripts done" << std::endl;
+
+    // New instance starts warm from process code cache
+    node::jscript::JSInstance* instance2 = create_instance();
+    run_scripts(instance2, script);
+    std::cout << "Second instance scripts done" << std::endl;
+
+    // Without caches
+    node::jscript::SetScriptCacheLimits(0, 0);
+    run_scripts(instance2, script);
+    std::cout << "Second instance scripts without cache done" << std::endl;
+
+    stop_instance(instance1);
+    stop_instance(instance2);
+    std::cout << "Instances stopped" << std::endl;
+
+    node::jscript::Uninitilize();
+    std::cout << "node::jscript::Uninitilize() done" << std::endl;
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,123 @@
+// Test for jscript Conan package manager
+// Script priority lanes, interactive scripts overtake queued background scripts,
+// stop script runs after queued scripts
+// Odant, 2021
+
+
+#ifdef NDEBUG
+#undef NDEBUG
+#endif
+
+#include <jscript.h>
+
+#include <iostream>
+#include <cstdlib>
+#include <string>
+#include <vector>
+#include <mutex>
+#include <future>
+#include <algorithm>
+#include <filesystem>
+#include <cassert>
+
+
+int main(int argc, char** argv) {
+
+    const std::string cwd = std::filesystem::current_path().string();
+    std::cout << "Current directory: " << cwd << std::endl;
+
+    const std::string origin = "http://127.0.0.1:8080";
+    const std::string externalOrigin = "http://127.0.0.1:8080";
+    const std::string executeFile = argv[0];
+    const std::string coreFolder = cwd;
+    const std::string nodeFolder = coreFolder + "/node_modules";
+
+    node::jscript::Initialize(origin, externalOrigin, executeFile, coreFolder, nodeFolder);
+    std::cout << "node::jscript::Initialize() done" << std::endl;
+
+    node::jscript::result_t res;
+    node::jscript::JSInstance* instance{nullptr};
+    res = node::jscript::CreateInstance(&instance);
+    assert(res == node::jscript::JS_SUCCESS);
+    assert(instance != nullptr);
+    std::cout << "Instance created" << std::endl;
+
+    std::mutex order_mutex;
+    std::vector<std::string> order;
+    const auto record = [&order_mutex, &order](const std::string& tag) {
+        return [&order_mutex, &order, tag](node::jscript::ScriptResult result) {
+            assert(result.status == node::jscript::JS_SUCCESS);
+            std::unique_lock<std::mutex> lock{order_mutex};
+            order.push_back(tag);
+        };
+    };
+
+    // Keep instance busy while lanes are filled
+    std::future<node::jscript::ScriptResult> blocker = node::jscript::RunScriptTextAsync(instance,
+        "const blockEnd = Date.now() + 300; while (Date.now() < blockEnd) {}", {}, node::jscript::ScriptPriority::Normal);
+
+    const std::size_t background_count = 100;
+    for (std::size_t i = 0; i < background_count; ++i) {
+        res = node::jscript::RunScriptText(instance, "var background = " + std::to_string(i) + ";", {},
+                                           record("background"), node::jscript::ScriptPriority::Background);
+        assert(res == node::jscript::JS_SUCCESS);
+    }
+    res = node::jscript::RunScriptText(instance, "var interactive = true;", {},
+                                       record("interactive"), node::jscript::ScriptPriority::Interactive);
+    assert(res == node::jscript::JS_SUCCESS);
+
+    assert(blocker.get().status == node::jscript::JS_SUCCESS);
+
+    // Lane order is kept, last background script completes after all others
+    node::jscript::ScriptResult last = node::jscript::RunScriptTextAsync(instance, "background;", {},
+                                                                         node::jscript::ScriptPriority::Background).get();
+    assert(last.status == node::jscript::JS_SUCCESS);
+    assert(last.value == std::to_string(background_count - 1));
+
+    {
+        std::unique_lock<std::mutex> lock{order_mutex};
+        assert(order.size() == background_count + 1);
+        const auto position = std::find(std::begin(order), std::end(order), "interactive") - std::begin(order);
+        std::cout << "Interactive script position: " << position << std::endl;
+        // At most one background script of the blocker round runs before
+        assert(position <= 1);
+    }
+
+    node::jscript::InstanceStats stats;
+    res = node::jscript::GetInstanceStats(instance, &stats);
+    assert(res == node::jscript::JS_SUCCESS);
+    const auto& interactiveLane = stats.lanes[static_cast<std::size_t>(node::jscript::ScriptPriority::Interactive)];
+    const auto& backgroundLane = stats.lanes[static_cast<std::size_t>(node::jscript::ScriptPriority::Background)];
+    std::cout << "Interactive queue time max: " << interactiveLane.queueTimeMax.count() << "us"
+              << ", background queue time max: " << backgroundLane.queueTimeMax.count() << "us" << std::endl;
+    assert(backgroundLane.scriptsDequeued >= background_count + 1);
+    assert(backgroundLane.queueTimeCount >= background_count + 1);
+    assert(backgroundLane.queueDepth == 0);
+    assert(interactiveLane.queueTimeCount >= 1);
+
+    // Scripts queued before stop run before stop script in all lanes
+    {
+        std::unique_lock<std::mutex> lock{order_mutex};
+        order.clear();
+    }
+    node::jscript::RunScriptTextAsync(instance, "const stopBlockEnd = Date.now() + 100; while (Date.now() < stopBlockEnd) {}",
+                                      {}, node::jscript::ScriptPriority::Background);
+    const std::size_t queued_count = 50;
+    for (std::size_t i = 0; i < queued_count; ++i) {
+        res = node::jscript::RunScriptText(instance, "var normal = " + std::to_string(i) + ";", {},
+                                           record("normal"), node::jscript::ScriptPriority::Normal);
+        assert(res == node::jscript::JS_SUCCESS);
+    }
+    res = node::jscript::StopInstance(instance);
+    assert(res == node::jscript::JS_SUCCESS);
+    std::cout << "Instance stopped" << std::endl;
+    {
+        std::unique_lock<std::mutex> lock{order_mutex};
+        assert(order.size() == queued_count);
+    }
+
+    node::jscript::Uninitilize();
+    std::cout << "node::jscript::Uninitilize() done" << std::endl;
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,102 @@
+// Test for jscript Conan package manager
+// Many concurrent RunScriptText submissions through instance script queue
+// Odant, 2021
+
+
+#include <jscript.h>
+
+#include <iostream>
+#include <cstdlib>
+#include <string>
+#include <vector>
+#include <thread>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <filesystem>
+
+
+static const std::size_t threads_count = 4;
+static const std::size_t scripts_per_thread = 1000;
+
+static std::atomic_size_t scripts_done{0};
+static std::mutex script_mutex;
+static std::condition_variable script_cv;
+static void script_cb(const v8::FunctionCallbackInfo<v8::Value>&) {
+    std::unique_lock<std::mutex> lock{script_mutex};
+    ++scripts_done;
+    script_cv.notify_all();
+}
+
+
+int main(int argc, char** argv) {
+
+    const std::string cwd = std::filesystem::current_path().string();
+    std::cout << "Current directory: " << cwd << std::endl;
+
+    const std::string origin = "http://127.0.0.1:8080";
+    const std::string externalOrigin = "http://127.0.0.1:8080";
+    const std::string executeFile = argv[0];
+    const std::string coreFolder = cwd;
+    const std::string nodeFolder = coreFolder + "/node_modules";
+
+    node::jscript::Initialize(origin, externalOrigin, executeFile, coreFolder, nodeFolder);
+    std::cout << "node::jscript::Initialize() done" << std::endl;
+
+    node::jscript::result_t res;
+    node::jscript::JSInstance* instance{nullptr};
+    res = node::jscript::CreateInstance(&instance);
+    if (res != node::jscript::JS_SUCCESS || !instance) {
+        std::cout << "Failed instance create" << std::endl;
+        std::exit(EXIT_FAILURE);
+    }
+    std::cout << "Instance created" << std::endl;
+
+    node::jscript::JSCallbackInfo resolveInfo;
+    resolveInfo.name = "scriptDone";
+    resolveInfo.function = script_cb;
+
+    const std::vector<node::jscript::JSCallbackInfo> callbacks{
+        std::move(resolveInfo)
+    };
+
+    std::atomic_bool failed{false};
+    std::vector<std::thread> threads;
+    for (std::size_t i = 0; i < threads_count; ++i) {
+        threads.emplace_back([instance, &callbacks, &failed, i]() {
+            for (std::size_t j = 0; j < scripts_per_thread; ++j) {
+                const std::string script = "var x" + std::to_string(i) + " = " + std::to_string(j) + ";\n"
+                                           "scriptDone();\n";
+                if (node::jscript::RunScriptText(instance, script, callbacks) != node::jscript::JS_SUCCESS) {
+                    failed = true;
+                }
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    if (failed) {
+        std::cout << "Failed running script" << std::endl;
+        std::exit(EXIT_FAILURE);
+    }
+
+    std::cout << "Scripts running, waiting..." << std::endl;
+    std::unique_lock<std::mutex> script_lock{script_mutex};
+    script_cv.wait(script_lock, [] { return scripts_done == threads_count * scripts_per_thread; });
+    script_lock.unlock();
+
+    std::cout << "Scripts done: " << scripts_done << std::endl;
+
+    res = node::jscript::StopInstance(instance);
+    if (res != node::jscript::JS_SUCCESS) {
+        std::cout << "Failed instance stop" << std::endl;
+        std::exit(EXIT_FAILURE);
+    }
+    std::cout << "Instance stopped" << std::endl;
+
+    node::jscript::Uninitilize();
+    std::cout << "node::jscript::Uninitilize() done" << std::endl;
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,96 @@
+// Test for jscript Conan package manager
+// Startup snapshot blob, LoadStartupSnapshot
+// Odant, 2021
+
+
+#ifdef NDEBUG
+#undef NDEBUG
+#endif
+
+#include <jscript.h>
+
+#include <iostream>
+#include <fstream>
+#include <cstdlib>
+#include <cstdint>
+#include <string>
+#include <filesystem>
+#include <cassert>
+
+
+int main(int argc, char** argv) {
+
+    const std::string cwd = std::filesystem::current_path().string();
+    std::cout << "Current directory: " << cwd << std::endl;
+
+    const std::string origin = "http://127.0.0.1:8080";
+    const std::string externalOrigin = "http://127.0.0.1:8080";
+    const std::string executeFile = argv[0];
+    const std::string coreFolder = cwd;
+    const std::string nodeFolder = coreFolder + "/node_modules";
+
+    node::jscript::Initialize(origin, externalOrigin, executeFile, coreFolder, nodeFolder);
+    std::cout << "node::jscript::Initialize() done" << std::endl;
+
+    node::jscript::result_t res;
+
+    res = node::jscript::LoadStartupSnapshot(cwd + "/not_exists.blob");
+    assert(res == node::jscript::JS_ERROR);
+
+    const std::string badBlob = cwd + "/bad_snapshot.blob";
+    {
+        std::ofstream file{badBlob, std::ios::binary};
+        file << "NOTASNAPSHOT";
+    }
+    res = node::jscript::LoadStartupSnapshot(badBlob);
+    assert(res == node::jscript::JS_ERROR);
+
+    // Blob of other node and V8 version
+    {
+        const std::string version = "v0.0.0 0.0.0";
+        const uint32_t versionSize = static_cast<uint32_t>(version.size());
+        const std::string data = "blob";
+        const uint32_t dataSize = static_cast<uint32_t>(data.size());
+        const uint64_t checksum = 0;
+        const uint32_t indexesCount = 0xFFFFFFFF;
+        std::ofstream file{badBlob, std::ios::binary | std::ios::trunc};
+        file << "NODESNAP";
+        file.write(reinterpret_cast<const char*>(&versionSize), sizeof(versionSize));
+        file << version;
+        file.write(reinterpret_cast<const char*>(&dataSize), sizeof(dataSize));
+        file << data;
+        file.write(reinterpret_cast<const char*>(&checksum), sizeof(checksum));
+        file.write(reinterpret_cast<const char*>(&indexesCount), sizeof(indexesCount));
+    }
+    res = node::jscript::LoadStartupSnapshot(badBlob);
+    assert(res == node::jscript::JS_ERROR);
+    std::filesystem::remove(badBlob);
+    std::cout << "Invalid blobs rejected" << std::endl;
+
+    const std::filesystem::path blob = std::filesystem::path{executeFile}.parent_path() / "jscript_snapshot.blob";
+    if (std::filesystem::exists(blob)) {
+        res = node::jscript::LoadStartupSnapshot(blob.string());
+        assert(res == node::jscript::JS_SUCCESS);
+        std::cout << "Snapshot loaded: " << blob.string() << std::endl;
+    }
+
+    node::jscript::JSInstance* instance{nullptr};
+    res = node::jscript::CreateInstance(&instance);
+    assert(res == node::jscript::JS_SUCCESS);
+    assert(instance != nullptr);
+    std::cout << "Instance created" << std::endl;
+
+    node::jscript::ScriptResult result = node::jscript::RunScriptTextAsync(instance, "typeof process.versions.node").get();
+    assert(result.status == node::jscript::JS_SUCCESS);
+    std::cout << "Script result: " << result.value << std::endl;
+    assert(result.value == "\"string\"");
+
+    res = node::jscript::StopInstance(instance);
+    assert(res == node::jscript::JS_SUCCESS);
+    std::cout << "Instance stopped" << std::endl;
+
+    node::jscript::Uninitilize();
+    std::cout << "node::jscript::Uninitilize() done" << std::endl;
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,119 @@
+// Test for jscript Conan package manager
+// fs.statBatch and fs.walkDir as single native request, callback and promise API
+// Odant, 2021
+
+
+#ifdef NDEBUG
+#undef NDEBUG
+#endif
+
+#include <jscript.h>
+
+#include <iostream>
+#include <cstdlib>
+#include <string>
+#include <mutex>
+#include <condition_variable>
+#include <filesystem>
+#include <cassert>
+
+
+static std::mutex done_mutex;
+static std::condition_variable done_cv;
+static bool is_done = false;
+static std::string done_result;
+static void done_cb(const v8::FunctionCallbackInfo<v8::Value>& args) {
+    v8::String::Utf8Value value(args.GetIsolate(), args[0]);
+    std::unique_lock<std::mutex> lock{done_mutex};
+    done_result = *value ? *value : "";
+    is_done = true;
+    done_cv.notify_all();
+}
+
+// Every check adds its name on failure, 'ok' is reported when all passed
+static const char* const test_script =
+    "const fs = require('fs');\n"
+    "const path = require('path');\n"
+    "const failed = [];\n"
+    "const check = (name, value) => { if (!value) failed.push(name); };\n"
+    "fs.rmSync('test_stat_batch', { recursive: true, force: true });\n"
+    "fs.mkdirSync('test_stat_batch/a/b', { recursive: true });\n"
+    "fs.writeFileSync('test_stat_batch/a/b/file.js', 'module.exports = 42;');\n"
+    "fs.writeFileSync('test_stat_batch/top.json', '{}');\n"
+    "const paths = ['test_stat_batch/top.json', 'test_stat_batch/missing.js',\n"
+    "               'test_stat_batch/top.json/index.js', 'test_stat_batch/a'];\n"
+    "fs.statBatch(paths, (err, stats) => {\n"
+    "  check('stat', err === null && stats.length === 4);\n"
+    "  check('stat file', stats[0].isFile() && stats[0].size === 2);\n"
+    "  check('stat missing', stats[1] === undefined && stats[2] === undefined);\n"
+    "  check('stat directory', stats[3].isDirectory());\n"
+    "  fs.walkDir('test_stat_batch', (err, result) => {\n"
+    "    check('walk', err === null && result.stats === undefined);\n"
+    "    const { UV_DIRENT_DIR, UV_DIRENT_FILE } = fs.constants;\n"
+    "    const entries = result.names.map((name, i) => name + ':' + result.types[i]).sort();\n"
+    "    const expected = [['a', UV_DIRENT_DIR], [path.join('a', 'b'), UV_DIRENT_DIR],\n"
+    "                      [path.join('a', 'b', 'file.js'), UV_DIRENT_FILE], ['top.json', UV_DIRENT_FILE]]\n"
+    "      .map(([name, type]) => name + ':' + type);\n"
+    "    check('walk entries', JSON.stringify(entries) === JSON.stringify(expected));\n"
+    "    fs.walkDir('test_stat_batch/missing', (err) => {\n"
+    "      check('walk missing', err && err.code === 'ENOENT');\n"
+    "      runPromises().then(() => statDone(failed.length ? failed.join() : 'ok'),\n"
+    "                         (err) => statDone(String(err)));\n"
+    "    });\n"
+    "  });\n"
+    "});\n"
+    "async function runPromises() {\n"
+    "  const fsp = fs.promises;\n"
+    "  const stats = await fsp.statBatch(paths, { bigint: true });\n"
+    "  check('promise stat', stats[0].size === 2n && stats[1] === undefined);\n"
+    "  check('promise empty', (await fsp.statBatch([])).length === 0);\n"
+    "  const result = await fsp.walkDir('test_stat_batch', { stats: true });\n"
+    "  const index = result.names.indexOf(path.join('a', 'b', 'file.js'));\n"
+    "  check('promise walk', index >= 0 && result.stats[index].size === 20);\n"
+    "  check('promise walk types', result.stats.every((s, i) => s.isDirectory() === (result.types[i] === fs.constants.UV_DIRENT_DIR)));\n"
+    "  fs.rmSync('test_stat_batch', { recursive: true });\n"
+    "}\n";
+
+
+int main(int argc, char** argv) {
+
+    const std::string cwd = std::filesystem::current_path().string();
+    std::cout << "Current directory: " << cwd << std::endl;
+
+    const std::string origin = "http://127.0.0.1:8080";
+    const std::string externalOrigin = "http://127.0.0.1:8080";
+    const std::string executeFile = argv[0];
+    const std::string coreFolder = cwd;
+    const std::string nodeFolder = coreFolder + "/node_modules";
+
+    node::jscript::Initialize(origin, externalOrigin, executeFile, coreFolder, nodeFolder);
+    std::cout << "node::jscript::Initialize() done" << std::endl;
+
+    node::jscript::result_t res;
+    node::jscript::JSInstance* instance{nullptr};
+    res = node::jscript::CreateInstance(&instance);
+    assert(res == node::jscript::JS_SUCCESS);
+    assert(instance != nullptr);
+    std::cout << "Instance created" << std::endl;
+
+    node::jscript::JSCallbackInfo callbackInfo;
+    callbackInfo.name = "statDone";
+    callbackInfo.function = done_cb;
+    res = node::jscript::RunScriptText(instance, test_script, {callbackInfo});
+    assert(res == node::jscript::JS_SUCCESS);
+
+    std::unique_lock<std::mutex> lock{done_mutex};
+    done_cv.wait(lock, [] { return is_done; });
+    lock.unlock();
+    std::cout << "Result: " << done_result << std::endl;
+    assert(done_result == "ok");
+
+    res = node::jscript::StopInstance(instance);
+    assert(res == node::jscript::JS_SUCCESS);
+    std::cout << "Instance stopped" << std::endl;
+
+    node::jscript::Uninitilize();
+    std::cout << "node::jscript::Uninitilize() done" << std::endl;
+
+    return EXIT_SUCCESS;
+}
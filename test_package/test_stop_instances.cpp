@@ -0,0 +1,84 @@
+// Test for jscript Conan package manager
+// Parallel stop of instances with grace period, StopInstances and Uninitilize
+// Odant, 2021
+
+
+#ifdef NDEBUG
+#undef NDEBUG
+#endif
+
+#include <jscript.h>
+
+#include <iostream>
+#include <cstdlib>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <filesystem>
+#include <cassert>
+
+
+int main(int argc, char** argv) {
+
+    const std::string cwd = std::filesystem::current_path().string();
+    std::cout << "Current directory: " << cwd << std::endl;
+
+    const std::string origin = "http://127.0.0.1:8080";
+    const std::string externalOrigin = "http://127.0.0.1:8080";
+    const std::string executeFile = argv[0];
+    const std::string coreFolder = cwd;
+    const std::string nodeFolder = coreFolder + "/node_modules";
+
+    node::jscript::Initialize(origin, externalOrigin, executeFile, coreFolder, nodeFolder);
+    std::cout << "node::jscript::Initialize() done" << std::endl;
+
+    node::jscript::result_t res;
+
+    const std::size_t instances_count = 4;
+    std::vector<node::jscript::JSInstance*> instances;
+    for (std::size_t i = 0; i < instances_count; ++i) {
+        node::jscript::JSInstance* instance{nullptr};
+        res = node::jscript::CreateInstance(&instance);
+        assert(res == node::jscript::JS_SUCCESS);
+        assert(instance != nullptr);
+        instances.push_back(instance);
+    }
+    std::cout << "Instances created" << std::endl;
+
+    // Last instance never finishes its script, stop script waits behind it
+    node::jscript::JSInstance* busy = instances.back();
+    res = node::jscript::RunScriptText(busy, "while (true) {}");
+    assert(res == node::jscript::JS_SUCCESS);
+
+    const auto gracePeriod = std::chrono::milliseconds{500};
+    const auto startTime = std::chrono::steady_clock::now();
+    std::vector<node::jscript::StopResult> results;
+    res = node::jscript::StopInstances(instances, gracePeriod, &results);
+    const auto stopTime = std::chrono::steady_clock::now() - startTime;
+    assert(res == node::jscript::JS_SUCCESS);
+    assert(results.size() == instances_count);
+    std::cout << "Instances stopped in " << std::chrono::duration_cast<std::chrono::milliseconds>(stopTime).count() << "ms" << std::endl;
+
+    for (std::size_t i = 0; i < results.size(); ++i) {
+        const auto& result = results[i];
+        std::cout << "Instance stopped: " << (result.status == node::jscript::JS_SUCCESS)
+                  << ", terminated: " << result.terminated
+                  << ", duration: " << result.duration.count() << "us" << std::endl;
+        assert(result.status == node::jscript::JS_SUCCESS);
+        assert(result.terminated == (instances[i] == busy));
+        assert(result.duration.count() > 0);
+    }
+    assert(stopTime < 2 * gracePeriod + std::chrono::seconds{5});
+
+    // Instance left running by host is stopped by Uninitilize
+    node::jscript::JSInstance* forgotten{nullptr};
+    res = node::jscript::CreateInstance(&forgotten);
+    assert(res == node::jscript::JS_SUCCESS);
+    res = node::jscript::RunScriptText(forgotten, "while (true) {}");
+    assert(res == node::jscript::JS_SUCCESS);
+
+    node::jscript::Uninitilize(gracePeriod);
+    std::cout << "node::jscript::Uninitilize() done" << std::endl;
+
+    return EXIT_SUCCESS;
+}
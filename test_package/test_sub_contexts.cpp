@@ -0,0 +1,127 @@
+// Test for jscript Conan package manager
+// Lightweight contexts inside instance, CreateContext/DestroyContext
+// Odant, 2021
+
+
+#ifdef NDEBUG
+#undef NDEBUG
+#endif
+
+#include <jscript.h>
+
+#include <iostream>
+#include <cstdlib>
+#include <string>
+#include <vector>
+#include <atomic>
+#include <filesystem>
+#include <cassert>
+
+
+static std::atomic_size_t tenant_calls{0};
+static void tenant_cb(const v8::FunctionCallbackInfo<v8::Value>& args) {
+    ++tenant_calls;
+    args.GetReturnValue().Set(static_cast<int32_t>(tenant_calls));
+}
+
+
+int main(int argc, char** argv) {
+
+    const std::string cwd = std::filesystem::current_path().string();
+    std::cout << "Current directory: " << cwd << std::endl;
+
+    const std::string origin = "http://127.0.0.1:8080";
+    const std::string externalOrigin = "http://127.0.0.1:8080";
+    const std::string executeFile = argv[0];
+    const std::string coreFolder = cwd;
+    const std::string nodeFolder = coreFolder + "/node_modules";
+
+    node::jscript::Initialize(origin, externalOrigin, executeFile, coreFolder, nodeFolder);
+    std::cout << "node::jscript::Initialize() done" << std::endl;
+
+    node::jscript::result_t res;
+    node::jscript::JSInstance* instance{nullptr};
+    res = node::jscript::CreateInstance(&instance);
+    assert(res == node::jscript::JS_SUCCESS);
+    assert(instance != nullptr);
+    std::cout << "Instance created" << std::endl;
+
+    node::jscript::JSContext* first{nullptr};
+    res = node::jscript::CreateContext(instance, &first);
+    assert(res == node::jscript::JS_SUCCESS);
+    assert(first != nullptr);
+
+    node::jscript::JSContext* second{nullptr};
+    res = node::jscript::CreateContext(instance, &second);
+    assert(res == node::jscript::JS_SUCCESS);
+    assert(second != nullptr);
+    std::cout << "Contexts created" << std::endl;
+
+    // Globals are separated
+    node::jscript::ScriptResult result;
+    result = node::jscript::RunScriptTextAsync(first, "var tenant = 'first'; tenant;").get();
+    assert(result.status == node::jscript::JS_SUCCESS);
+    assert(result.value == "\"first\"");
+
+    result = node::jscript::RunScriptTextAsync(second, "var tenant = 'second'; tenant;").get();
+    assert(result.status == node::jscript::JS_SUCCESS);
+    assert(result.value == "\"second\"");
+
+    result = node::jscript::RunScriptTextAsync(first, "tenant;").get();
+    assert(result.status == node::jscript::JS_SUCCESS);
+    assert(result.value == "\"first\"");
+
+    result = node::jscript::RunScriptTextAsync(instance, "typeof tenant;").get();
+    assert(result.status == node::jscript::JS_SUCCESS);
+    assert(result.value == "\"undefined\"");
+
+    // Same script text is compiled once for all contexts of instance
+    const std::string script = "typeof require + ':' + typeof console.log;";
+    result = node::jscript::RunScriptTextAsync(first, script).get();
+    assert(result.status == node::jscript::JS_SUCCESS);
+    assert(result.value == "\"undefined:function\"");
+    result = node::jscript::RunScriptTextAsync(second, script).get();
+    assert(result.status == node::jscript::JS_SUCCESS);
+    assert(result.value == "\"undefined:function\"");
+
+    result = node::jscript::RunScriptTextAsync(second, "console.log('hello from context'); throw new Error('tenant error');").get();
+    assert(result.status == node::jscript::JS_ERROR);
+    assert(result.exception.find("tenant error") != std::string::npos);
+    std::cout << "Scripts in contexts done" << std::endl;
+
+    // Callbacks are bound only to own context
+    node::jscript::JSCallbackInfo tenantInfo;
+    tenantInfo.name = "tenantCall";
+    tenantInfo.function = tenant_cb;
+    res = node::jscript::RegisterCallbacks(first, {tenantInfo});
+    assert(res == node::jscript::JS_SUCCESS);
+
+    result = node::jscript::RunScriptTextAsync(first, "tenantCall();").get();
+    assert(result.status == node::jscript::JS_SUCCESS);
+    assert(result.value == "1");
+    result = node::jscript::RunScriptTextAsync(second, "typeof tenantCall;").get();
+    assert(result.status == node::jscript::JS_SUCCESS);
+    assert(result.value == "\"undefined\"");
+    assert(tenant_calls == 1);
+
+    res = node::jscript::DestroyContext(first);
+    assert(res == node::jscript::JS_SUCCESS);
+    std::cout << "Context destroyed" << std::endl;
+
+    result = node::jscript::RunScriptTextAsync(second, "tenant;").get();
+    assert(result.status == node::jscript::JS_SUCCESS);
+    assert(result.value == "\"second\"");
+
+    res = node::jscript::StopInstance(instance);
+    assert(res == node::jscript::JS_SUCCESS);
+    std::cout << "Instance stopped" << std::endl;
+
+    // Context handle outlives instance
+    res = node::jscript::DestroyContext(second);
+    assert(res == node::jscript::JS_SUCCESS);
+
+    node::jscript::Uninitilize();
+    std::cout << "node::jscript::Uninitilize() done" << std::endl;
+
+    return EXIT_SUCCESS;
+}
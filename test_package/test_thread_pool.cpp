@@ -0,0 +1,136 @@
+// Test for jscript Conan package manager
+// Thread pool of group of instances and own thread pool of instance
+// Odant, 2021
+
+
+#ifdef NDEBUG
+#undef NDEBUG
+#endif
+
+#include <jscript.h>
+
+#include <iostream>
+#include <cstdlib>
+#include <string>
+#include <vector>
+#include <mutex>
+#include <condition_variable>
+#include <filesystem>
+#include <cassert>
+
+
+static std::mutex work_mutex;
+static std::condition_variable work_cv;
+static std::size_t work_done = 0;
+static void work_cb(const v8::FunctionCallbackInfo<v8::Value>&) {
+    std::unique_lock<std::mutex> lock{work_mutex};
+    ++work_done;
+    work_cv.notify_all();
+}
+
+// pbkdf2 is done in thread pool, fs.stat too unless io_uring is enabled by UV_USE_IO_URING=1 (Linux)
+static void run_work(node::jscript::JSInstance* instance, std::size_t count) {
+    node::jscript::JSCallbackInfo callbackInfo;
+    callbackInfo.name = "workDone";
+    callbackInfo.function = work_cb;
+
+    const std::string script =
+        "const crypto = require('crypto');\n"
+        "const fs = require('fs');\n"
+        "for (let i = 0; i < " + std::to_string(count) + "; ++i) {\n"
+        "  crypto.pbkdf2('secret', 'salt', 1000, 32, 'sha256', (err) => { if (!err) workDone(); });\n"
+        "  fs.stat('.', (err) => { if (!err) workDone(); });\n"
+        "}\n";
+    const node::jscript::result_t res = node::jscript::RunScriptText(instance, script, {callbackInfo});
+    assert(res == node::jscript::JS_SUCCESS);
+}
+
+
+int main(int argc, char** argv) {
+
+    const std::string cwd = std::filesystem::current_path().string();
+    std::cout << "Current directory: " << cwd << std::endl;
+
+    const std::string origin = "http://127.0.0.1:8080";
+    const std::string externalOrigin = "http://127.0.0.1:8080";
+    const std::string executeFile = argv[0];
+    const std::string coreFolder = cwd;
+    const std::string nodeFolder = coreFolder + "/node_modules";
+
+    node::jscript::Initialize(origin, externalOrigin, executeFile, coreFolder, nodeFolder);
+    std::cout << "node::jscript::Initialize() done" << std::endl;
+
+    node::jscript::result_t res;
+
+    node::jscript::JSThreadPool* pool{nullptr};
+    res = node::jscript::CreateThreadPool(2, &pool);
+    assert(res == node::jscript::JS_SUCCESS);
+    assert(pool != nullptr);
+
+    node::jscript::ThreadPoolStats poolStats;
+    res = node::jscript::GetThreadPoolStats(pool, &poolStats);
+    assert(res == node::jscript::JS_SUCCESS);
+    assert(poolStats.threads == 2);
+    assert(poolStats.submitted == 0);
+
+    // Two instances of group, one with own pool
+
+    node::jscript::InstanceOptions groupOptions;
+    groupOptions.threadPool = pool;
+
+    node::jscript::InstanceOptions ownOptions;
+    ownOptions.threadPoolSize = 1;
+
+    std::vector<node::jscript::JSInstance*> instances(3, nullptr);
+    res = node::jscript::CreateInstance(groupOptions, &instances[0]);
+    assert(res == node::jscript::JS_SUCCESS);
+    res = node::jscript::CreateInstance(groupOptions, &instances[1]);
+    assert(res == node::jscript::JS_SUCCESS);
+    res = node::jscript::CreateInstance(ownOptions, &instances[2]);
+    assert(res == node::jscript::JS_SUCCESS);
+    std::cout << "Instances created" << std::endl;
+
+    const std::size_t count = 20;
+    for (auto instance : instances) {
+        run_work(instance, count);
+    }
+
+    std::unique_lock<std::mutex> lock{work_mutex};
+    const std::size_t expected = instances.size() * count * 2;
+    work_cv.wait(lock, [expected] { return work_done == expected; });
+    lock.unlock();
+    std::cout << "Work done: " << work_done << std::endl;
+
+    node::jscript::InstanceStats stats;
+    res = node::jscript::GetInstanceStats(instances[0], &stats);
+    assert(res == node::jscript::JS_SUCCESS);
+    assert(stats.threadPoolThreads == 2);
+    assert(stats.threadPoolQueueDepth == 0);
+
+    res = node::jscript::GetThreadPoolStats(pool, &poolStats);
+    assert(res == node::jscript::JS_SUCCESS);
+    std::cout << "Group pool submitted: " << poolStats.submitted << ", completed: " << poolStats.completed << std::endl;
+    assert(poolStats.submitted >= 2 * count);
+    assert(poolStats.queueDepth == 0);
+
+    // Pool is kept by its instances
+    res = node::jscript::ReleaseThreadPool(pool);
+    assert(res == node::jscript::JS_SUCCESS);
+
+    res = node::jscript::GetInstanceStats(instances[2], &stats);
+    assert(res == node::jscript::JS_SUCCESS);
+    assert(stats.threadPoolThreads == 1);
+
+    res = node::jscript::GetThreadPoolStats(nullptr, &poolStats);
+    assert(res == node::jscript::JS_SUCCESS);
+    std::cout << "Process pool threads: " << poolStats.threads << ", submitted: " << poolStats.submitted << std::endl;
+
+    res = node::jscript::StopInstances(instances);
+    assert(res == node::jscript::JS_SUCCESS);
+    std::cout << "Instances stopped" << std::endl;
+
+    node::jscript::Uninitilize();
+    std::cout << "node::jscript::Uninitilize() done" << std::endl;
+
+    return EXIT_SUCCESS;
+}